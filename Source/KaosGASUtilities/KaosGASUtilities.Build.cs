@@ -75,6 +75,11 @@ public class KaosGASUtilities : ModuleRules
 			}
 		);
 
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
+
 
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
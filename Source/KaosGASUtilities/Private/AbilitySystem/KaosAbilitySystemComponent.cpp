@@ -21,7 +21,11 @@
 #include "AbilitySystem/KaosAbilitySystemComponent.h"
 #include "KaosUtilitiesLogging.h"
 #include "AbilitySystem/KaosAbilityTagRelationships.h"
+#include "AbilitySystem/KaosAttributeChangeBuffer.h"
+#include "AbilitySystem/KaosAbilitySystemGlobals.h"
 #include "AbilitySystem/KaosGameplayAbility.h"
+#include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
+#include "GameplayEffect.h"
 #include "GameFramework/Pawn.h"
 
 void UKaosAbilitySystemComponent::ApplyAbilityBlockAndCancelTags(const FGameplayTagContainer& AbilityTags, UGameplayAbility* RequestingAbility, bool bEnableBlockTags, const FGameplayTagContainer& BlockTags, bool bExecuteCancelTags,
@@ -37,6 +41,11 @@ void UKaosAbilitySystemComponent::ApplyAbilityBlockAndCancelTags(const FGameplay
 	}
 
 	Super::ApplyAbilityBlockAndCancelTags(AbilityTags, RequestingAbility, bEnableBlockTags, AbilityBlockTags, bExecuteCancelTags, AbilityCancelTags);
+
+	if (!AbilityBlockTags.IsEmpty())
+	{
+		OnAbilityBlockTagsChanged.Broadcast();
+	}
 }
 
 void UKaosAbilitySystemComponent::K2_UnBlockAbilitiesWithTags(FGameplayTagContainer& Tags)
@@ -88,6 +97,127 @@ void UKaosAbilitySystemComponent::NotifyAbilityEnded(FGameplayAbilitySpecHandle
 	}
 }
 
+void UKaosAbilitySystemComponent::CaptureAttributeForGameplayEffect(FGameplayEffectAttributeCaptureSpec& OutCaptureSpec)
+{
+	AttributesWithAggregators.Add(OutCaptureSpec.BackingDefinition.AttributeToCapture);
+	Super::CaptureAttributeForGameplayEffect(OutCaptureSpec);
+}
+
+void UKaosAbilitySystemComponent::OnActiveGameplayEffectAddedToSelf(UAbilitySystemComponent* Target, const FGameplayEffectSpec& SpecApplied, FActiveGameplayEffectHandle ActiveHandle)
+{
+	// Instant effects write base values directly, only the modifiers of duration effects are kept in aggregators
+	if (SpecApplied.Def)
+	{
+		for (const FGameplayModifierInfo& Modifier : SpecApplied.Def->Modifiers)
+		{
+			AttributesWithAggregators.Add(Modifier.Attribute);
+		}
+	}
+}
+
+void UKaosAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	Super::OnGiveAbility(AbilitySpec);
+
+	KaosOnGiveAbility.ExecuteIfBound(AbilitySpec);
+	OnAbilityGranted.Broadcast(AbilitySpec);
+}
+
+void UKaosAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
+{
+	OnAbilityRemoved.Broadcast(AbilitySpec);
+
+	Super::OnRemoveAbility(AbilitySpec);
+}
+
+void UKaosAbilitySystemComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	// Broadcast for duration effects on the server and for replicated ones on clients
+	ActiveGameplayEffectAddedHandle = OnActiveGameplayEffectAddedDelegateToSelf.AddUObject(this, &UKaosAbilitySystemComponent::OnActiveGameplayEffectAddedToSelf);
+}
+
+void UKaosAbilitySystemComponent::OnUnregister()
+{
+	OnActiveGameplayEffectAddedDelegateToSelf.Remove(ActiveGameplayEffectAddedHandle);
+	ActiveGameplayEffectAddedHandle.Reset();
+	ReleaseAttributeChangedEventWrappers();
+	StopRecordingAttributeChanges();
+	Super::OnUnregister();
+}
+
+void UKaosAbilitySystemComponent::RegisterAttributeChangedEventWrapper(const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec>& EventWrapper)
+{
+	// Release wrappers whose objects were destroyed without unbinding and whose attributes have not changed since
+	TArray<TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>, TInlineAllocator<4>> OrphanedEventWrappers;
+	for (const TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>& Existing : AttributeChangedEventWrappers)
+	{
+		if (!Existing->GameplayAttributeChangedEventWrapperDelegate.IsBound())
+		{
+			OrphanedEventWrappers.Add(Existing);
+		}
+	}
+	for (const TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>& OrphanedEventWrapper : OrphanedEventWrappers)
+	{
+		OrphanedEventWrapper->UnbindAll();
+	}
+
+	AttributeChangedEventWrappers.AddUnique(EventWrapper);
+}
+
+void UKaosAbilitySystemComponent::UnregisterAttributeChangedEventWrapper(const FKaosGameplayAttributeChangedEventWrapperSpec* EventWrapper)
+{
+	AttributeChangedEventWrappers.RemoveAllSwap([EventWrapper](const TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>& Existing) { return Existing.Get() == EventWrapper; }, EAllowShrinking::No);
+}
+
+void UKaosAbilitySystemComponent::ReleaseAttributeChangedEventWrappers()
+{
+	// Unbinding unregisters each wrapper, work on a copy so the array is not modified while iterating it
+	const TArray<TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>> EventWrappers = MoveTemp(AttributeChangedEventWrappers);
+	AttributeChangedEventWrappers.Reset();
+	for (const TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>& EventWrapper : EventWrappers)
+	{
+		EventWrapper->UnbindAll();
+	}
+}
+
+TSharedRef<FKaosAttributeChangeBuffer> UKaosAbilitySystemComponent::StartRecordingAttributeChanges(TConstArrayView<FGameplayAttribute> Attributes, uint32 Capacity)
+{
+	StopRecordingAttributeChanges();
+
+	TArray<FGameplayAttribute> AttributesToRecord(Attributes);
+	if (AttributesToRecord.IsEmpty())
+	{
+		GetAllAttributes(AttributesToRecord);
+	}
+
+	TSharedRef<FKaosAttributeChangeBuffer> Buffer = MakeShared<FKaosAttributeChangeBuffer>(Capacity);
+	AttributeChangeBuffer = Buffer;
+	AttributeChangeBufferBindings.Reserve(AttributesToRecord.Num());
+	for (const FGameplayAttribute& Attribute : AttributesToRecord)
+	{
+		AttributeChangeBufferBindings.Emplace(Attribute, GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(this, &ThisClass::RecordAttributeChange));
+	}
+	return Buffer;
+}
+
+void UKaosAbilitySystemComponent::StopRecordingAttributeChanges()
+{
+	for (const TPair<FGameplayAttribute, FDelegateHandle>& Binding : AttributeChangeBufferBindings)
+	{
+		GetGameplayAttributeValueChangeDelegate(Binding.Key).Remove(Binding.Value);
+	}
+	AttributeChangeBufferBindings.Reset();
+	AttributeChangeBuffer.Reset();
+}
+
+void UKaosAbilitySystemComponent::RecordAttributeChange(const FOnAttributeChangeData& ChangeData)
+{
+	const UWorld* World = GetWorld();
+	AttributeChangeBuffer->Record({ World ? World->GetTimeSeconds() : 0.0, ChangeData.Attribute, ChangeData.OldValue, ChangeData.NewValue });
+}
+
 FActiveGameplayEffect* UKaosAbilitySystemComponent::GetActiveGameplayEffect_Mutable(FActiveGameplayEffectHandle Handle)
 {
 	return ActiveGameplayEffects.GetActiveGameplayEffect(Handle);
@@ -98,35 +228,180 @@ TArray<FActiveGameplayEffectHandle> UKaosAbilitySystemComponent::GetAllActiveEff
 	return ActiveGameplayEffects.GetAllActiveEffectHandles();
 }
 
-bool UKaosAbilitySystemComponent::CanApplyAttributeModifiers(FGameplayEffectSpec EffectSpec)
+void UKaosAbilitySystemComponent::ForEachActiveEffect(const FGameplayEffectQuery& Query, TFunctionRef<EKaosActiveEffectVisitResult(FActiveGameplayEffect&)> Visitor)
 {
-	EffectSpec.CalculateModifierMagnitudes();
-
-	for (int32 ModIdx = 0; ModIdx < EffectSpec.Modifiers.Num(); ++ModIdx)
+	TArray<FActiveGameplayEffect*, TInlineAllocator<16>> MutatedEffects;
 	{
-		const FGameplayModifierInfo& ModDef = EffectSpec.Def->Modifiers[ModIdx];
-		const FModifierSpec& ModSpec = EffectSpec.Modifiers[ModIdx];
-
-		// It only makes sense to check additive operators
-		if (ModDef.ModifierOp == EGameplayModOp::Additive)
+		FScopedActiveGameplayEffectLock ActiveScopeLock(ActiveGameplayEffects);
+		for (FActiveGameplayEffect& ActiveEffect : &ActiveGameplayEffects)
 		{
-			if (!ModDef.Attribute.IsValid())
+			if (ActiveEffect.IsPendingRemove || !Query.Matches(ActiveEffect))
 			{
 				continue;
 			}
-			const UAttributeSet* Set = GetAttributeSubobject(ModDef.Attribute.GetAttributeSetClass());
-			const float CurrentValue = ModDef.Attribute.GetNumericValueChecked(Set);
-			const float CostValue = ModSpec.GetEvaluatedMagnitude();
 
-			if (CurrentValue + CostValue < 0.f)
+			const EKaosActiveEffectVisitResult Result = Visitor(ActiveEffect);
+			if (EnumHasAnyFlags(Result, EKaosActiveEffectVisitResult::MarkDirty))
 			{
-				return false;
+				MutatedEffects.Add(&ActiveEffect);
 			}
+			if (EnumHasAnyFlags(Result, EKaosActiveEffectVisitResult::Stop))
+			{
+				break;
+			}
+		}
+
+		// Mark while still locked, the collected pointers are only guaranteed valid until the lock is released
+		for (FActiveGameplayEffect* MutatedEffect : MutatedEffects)
+		{
+			ActiveGameplayEffects.MarkItemDirty(*MutatedEffect);
 		}
 	}
+}
+
+bool UKaosAbilitySystemComponent::CanApplyAttributeModifiers(const FGameplayEffectSpec& EffectSpec)
+{
+	return UKaosAbilitySystemGlobals::CanApplyAttributeModifiers(*this, EffectSpec);
+}
+
+void UKaosAbilitySystemComponent::RegisterGrantedAbilitySet(const FKaosAbilitySetHandle& Handle)
+{
+	if (ensure(Handle.HandleId != 0))
+	{
+		GrantedAbilitySets.Add(Handle.HandleId, Handle);
+	}
+}
+
+bool UKaosAbilitySystemComponent::RemoveGrantedAbilitySet(int32 HandleId)
+{
+	FKaosAbilitySetHandle GrantedSet;
+	if (!GrantedAbilitySets.RemoveAndCopyValue(HandleId, GrantedSet))
+	{
+		return false;
+	}
+
+	GrantedSet.RemoveGrantedItems(*this);
 	return true;
 }
 
+bool UKaosAbilitySystemComponent::UnregisterGrantedAbilitySet(int32 HandleId, FKaosAbilitySetHandle& OutGrantedSet)
+{
+	return GrantedAbilitySets.RemoveAndCopyValue(HandleId, OutGrantedSet);
+}
+
+void UKaosAbilitySystemComponent::RemoveAllGrantedAbilitySets()
+{
+	// Move the registry out first, removing abilities can end up granting or removing sets re-entrantly
+	TMap<int32, FKaosAbilitySetHandle> RemovedSets = MoveTemp(GrantedAbilitySets);
+	GrantedAbilitySets.Reset();
+
+	for (const TPair<int32, FKaosAbilitySetHandle>& GrantedSet : RemovedSets)
+	{
+		GrantedSet.Value.RemoveGrantedItems(*this);
+	}
+}
+
+FKaosScopedAbilityGrantBatch::FKaosScopedAbilityGrantBatch(UKaosAbilitySystemComponent& InAbilitySystemComponent, int32 NumAbilitiesToGrant)
+	: AbilitySystemComponent(InAbilitySystemComponent)
+{
+	AbilitySystemComponent.BeginAbilityGrantBatch(NumAbilitiesToGrant);
+	AbilityListLock.Emplace(AbilitySystemComponent);
+}
+
+FKaosScopedAbilityGrantBatch::~FKaosScopedAbilityGrantBatch()
+{
+	// Releasing the lock gives the pending specs, their passive activations are queued while the batch is still open.
+	AbilityListLock.Reset();
+	AbilitySystemComponent.EndAbilityGrantBatch();
+}
+
+void UKaosAbilitySystemComponent::BeginAbilityGrantBatch(int32 NumAbilitiesToGrant)
+{
+	if (AbilityGrantBatchDepth++ == 0 && NumAbilitiesToGrant > 0)
+	{
+		ActivatableAbilities.Items.Reserve(ActivatableAbilities.Items.Num() + NumAbilitiesToGrant);
+	}
+}
+
+void UKaosAbilitySystemComponent::EndAbilityGrantBatch()
+{
+	check(AbilityGrantBatchDepth > 0);
+	if (--AbilityGrantBatchDepth > 0)
+	{
+		return;
+	}
+
+	const TArray<FGameplayAbilitySpecHandle> PassiveAbilities = MoveTemp(DeferredPassiveAbilities);
+	DeferredPassiveAbilities.Reset();
+
+	for (const FGameplayAbilitySpecHandle& Handle : PassiveAbilities)
+	{
+		const FGameplayAbilitySpec* Spec = FindAbilitySpecFromHandle(Handle);
+		if (!Spec)
+		{
+			continue;
+		}
+
+		const UGameplayAbility* Ability = Spec->GetPrimaryInstance() ? Spec->GetPrimaryInstance() : Spec->Ability.Get();
+		if (const UKaosGameplayAbility* KaosAbility = Cast<UKaosGameplayAbility>(Ability))
+		{
+			KaosAbility->TryActivatePassiveAbility(AbilityActorInfo.Get(), *Spec);
+		}
+	}
+
+	ForceReplication();
+}
+
+void UKaosAbilitySystemComponent::DeferPassiveAbilityActivation(const FGameplayAbilitySpecHandle& Handle)
+{
+	if (ensure(IsGrantingAbilityBatch()))
+	{
+		DeferredPassiveAbilities.AddUnique(Handle);
+	}
+}
+
+UAttributeSet* UKaosAbilitySystemComponent::AcquireAttributeSet(TSubclassOf<UAttributeSet> AttributeSetClass)
+{
+	check(AttributeSetClass);
+
+	TObjectPtr<UAttributeSet> AttributeSet;
+	if (PooledAttributeSets.RemoveAndCopyValue(AttributeSetClass.Get(), AttributeSet) && IsValid(AttributeSet))
+	{
+		// Only the attributes are reset, anything else on the set is left as the previous owner had it.
+		const UAttributeSet* DefaultSet = AttributeSetClass->GetDefaultObject<UAttributeSet>();
+		for (TFieldIterator<FProperty> It(AttributeSetClass); It; ++It)
+		{
+			if (FGameplayAttribute::IsSupportedProperty(*It))
+			{
+				It->CopyCompleteValue_InContainer(AttributeSet, DefaultSet);
+			}
+		}
+	}
+	else
+	{
+		AttributeSet = NewObject<UAttributeSet>(GetOwner(), AttributeSetClass);
+	}
+
+	AddSpawnedAttribute(AttributeSet);
+	return AttributeSet;
+}
+
+void UKaosAbilitySystemComponent::ReleaseAttributeSet(UAttributeSet* AttributeSet)
+{
+	if (!AttributeSet)
+	{
+		return;
+	}
+
+	RemoveSpawnedAttribute(AttributeSet);
+	PooledAttributeSets.Add(AttributeSet->GetClass(), AttributeSet);
+}
+
+void UKaosAbilitySystemComponent::EmptyAttributeSetPool()
+{
+	PooledAttributeSets.Empty();
+}
+
 void UKaosAbilitySystemComponent::MarkActiveGameplayEffectDirty(FActiveGameplayEffect* ActiveGE)
 {
 	if (ActiveGE)
@@ -19,6 +19,19 @@
 // DEALINGS IN THE SOFTWARE.
 
 #include "AbilitySystem/KaosAbilitySystemGlobals.h"
+#include "AbilitySystemComponent.h"
+#include "GameplayEffect.h"
+#include "KaosUtilitiesLogging.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
+#include "Engine/CurveTable.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "Subsystems/ImportSubsystem.h"
+#endif
 
 FKaosAttributeSetInitter* UKaosAbilitySystemGlobals::GetKaosAttributeSetInitter() const
 {
@@ -30,11 +43,7 @@ void UKaosAbilitySystemGlobals::InitAttributeSetDefaults(UAbilitySystemComponent
 {
 	if (ensure(Key.IsValid()))
 	{
-		FName GroupName = Key.GetAttributeInitCategory();
-		if (!Key.GetAttributeInitSubCategory().IsNone())
-		{
-			GroupName = FName(*FString::Printf(TEXT("%s.%s"), *Key.GetAttributeInitCategory().ToString(), *Key.GetAttributeInitSubCategory().ToString()));
-		}
+		const FName GroupName = GetAttributeInitGroupName(Key);
 		GetKaosAttributeSetInitter()->InitAttributeSetDefaults(AbilitySystemComponent, GroupName, Level, bInitialInit);
 	}
 }
@@ -43,37 +52,388 @@ void UKaosAbilitySystemGlobals::ApplyAttributeSetDefaults(UAbilitySystemComponen
 {
 	if (ensure(Key.IsValid()))
 	{
-		FName GroupName = Key.GetAttributeInitCategory();
-		if (!Key.GetAttributeInitSubCategory().IsNone())
-		{
-			GroupName = FName(*FString::Printf(TEXT("%s.%s"), *Key.GetAttributeInitCategory().ToString(), *Key.GetAttributeInitSubCategory().ToString()));
-		}
+		const FName GroupName = GetAttributeInitGroupName(Key);
 		GetKaosAttributeSetInitter()->ApplyAttributeDefault(AbilitySystemComponent, InAttribute, GroupName, Level);
 	}
 }
 
 TArray<float> UKaosAbilitySystemGlobals::GetAttributeSetValues(UClass* AttributeSetClass, FProperty* AttributeProperty, const FKaosAttributeInitializationKey& Key) const
+{
+	return TArray<float>(GetAttributeSetValuesView(AttributeSetClass, AttributeProperty, Key));
+}
+
+TConstArrayView<float> UKaosAbilitySystemGlobals::GetAttributeSetValuesView(const UClass* AttributeSetClass, const FProperty* AttributeProperty, const FKaosAttributeInitializationKey& Key) const
 {
 	if (ensure(Key.IsValid()))
 	{
-		FName GroupName = Key.GetAttributeInitCategory();
-		if (!Key.GetAttributeInitSubCategory().IsNone())
+		const FName GroupName = GetAttributeInitGroupName(Key);
+		return GetKaosAttributeSetInitter()->GetAttributeSetValuesView(AttributeSetClass, AttributeProperty, GroupName);
+	}
+	return {};
+}
+
+void UKaosAbilitySystemGlobals::InitAttributeSetDefaultsBatch(TConstArrayView<FKaosAttributeSetDefaultsBatchEntry> Entries, bool bInitialInit)
+{
+	TArray<FKaosAttributeSetInitRequest> Requests;
+	Requests.Reserve(Entries.Num());
+
+	// Entries of a wave usually share their key, avoid building the same group name for each of them
+	const FKaosAttributeInitializationKey* LastKey = nullptr;
+	FName GroupName;
+	for (const FKaosAttributeSetDefaultsBatchEntry& Entry : Entries)
+	{
+		if (!ensure(Entry.Key.IsValid()))
+		{
+			continue;
+		}
+
+		if (!LastKey || LastKey->GetAttributeInitCategory() != Entry.Key.GetAttributeInitCategory() || LastKey->GetAttributeInitSubCategory() != Entry.Key.GetAttributeInitSubCategory())
 		{
-			GroupName = FName(*FString::Printf(TEXT("%s.%s"), *Key.GetAttributeInitCategory().ToString(), *Key.GetAttributeInitSubCategory().ToString()));
+			LastKey = &Entry.Key;
+			GroupName = GetAttributeInitGroupName(Entry.Key);
 		}
-		return GetKaosAttributeSetInitter()->GetAttributeSetValues(AttributeSetClass, AttributeProperty, GroupName);
+		Requests.Add({ Entry.AbilitySystemComponent, GroupName, Entry.Level });
 	}
-	return {};
+
+	GetKaosAttributeSetInitter()->InitAttributeSetDefaultsBatch(Requests, bInitialInit);
+}
+
+FName UKaosAbilitySystemGlobals::GetAttributeInitGroupName(const FKaosAttributeInitializationKey& Key)
+{
+	if (Key.GetAttributeInitSubCategory().IsNone())
+	{
+		return Key.GetAttributeInitCategory();
+	}
+	return FName(*FString::Printf(TEXT("%s.%s"), *Key.GetAttributeInitCategory().ToString(), *Key.GetAttributeInitSubCategory().ToString()));
 }
 
 void UKaosAbilitySystemGlobals::AllocAttributeSetInitter()
 {
-	GlobalAttributeSetInitter = MakeShared<FKaosAttributeSetInitter>();
+	GlobalAttributeSetInitter = MakeShared<FKaosAttributeSetInitter>(AttributeDefaultsInterpolation, AttributeDefaultsExtrapolation, AttributeDefaultsMaxLevel);
+}
+
+void UKaosAbilitySystemGlobals::InitAttributeDefaults()
+{
+	// Processes that never edit defaults share the cooked file pages, the curve tables are neither loaded nor parsed
+	if (!GIsEditor && !CookedAttributeDefaultsPath.IsEmpty() && !bParseAttributeDefaultsTables && LoadCookedAttributeDefaults())
+	{
+		return;
+	}
+
+	Super::InitAttributeDefaults();
+
+#if WITH_EDITOR
+	// Reimports also broadcast OnCurveTableChanged, drop the full reload the base class registers for them so they are not handled twice
+	if (GEditor)
+	{
+		if (UImportSubsystem* ImportSubsystem = GEditor->GetEditorSubsystem<UImportSubsystem>())
+		{
+			ImportSubsystem->OnAssetReimport.RemoveAll(this);
+		}
+	}
+#endif
+
+	// Edits, reimports and hotfixes of a single table only need that table reparsed
+	for (UCurveTable* CurveTable : GlobalAttributeDefaultsTables)
+	{
+		if (CurveTable)
+		{
+			BindAttributeDefaultsTable(*CurveTable);
+		}
+	}
 }
 
 void UKaosAbilitySystemGlobals::ReloadAttributeDefaults()
 {
+	// Cooked defaults reload from the file, the tables are only parsed once one of them changed in this process
+	if (!bParseAttributeDefaultsTables && GlobalAttributeSetInitter.IsValid() && GetKaosAttributeSetInitter()->IsUsingCookedDefaults())
+	{
+		if (!LoadCookedAttributeDefaults())
+		{
+			bParseAttributeDefaultsTables = true;
+			InitAttributeDefaults();
+		}
+		return;
+	}
+
 	Super::ReloadAttributeDefaults();
+	FlushCachedModifierMagnitudes();
+}
+
+bool UKaosAbilitySystemGlobals::LoadCookedAttributeDefaults()
+{
+	const FString Filename = GetCookedAttributeDefaultsFilename();
+	uint32 SourceStamp = 0;
+	if (!ComputeAttributeDefaultsSourceStamp(SourceStamp))
+	{
+		UE_LOG(LogKaosUtilities, Warning, TEXT("The asset registry has no package data for the attribute defaults tables, parsing the tables instead of %s"), *Filename);
+		return false;
+	}
+
+	AllocAttributeSetInitter();
+	if (!GetKaosAttributeSetInitter()->LoadCookedDefaults(Filename, SourceStamp))
+	{
+		UE_LOG(LogKaosUtilities, Warning, TEXT("Cooked attribute defaults %s are missing or were compiled from other tables, parsing the tables instead"), *Filename);
+		return false;
+	}
+	FlushCachedModifierMagnitudes();
+
+	// The tables are not loaded, a hotfix loading one to patch it has to switch this process over to parsing them
+	if (!EndLoadPackageHandle.IsValid())
+	{
+		EndLoadPackageHandle = FCoreUObjectDelegates::OnEndLoadPackage.AddUObject(this, &UKaosAbilitySystemGlobals::OnEndLoadPackage);
+	}
+	for (const FSoftObjectPath& TablePath : GetGlobalAttributeSetDefaultsTablePaths())
+	{
+		if (UCurveTable* CurveTable = Cast<UCurveTable>(TablePath.ResolveObject()))
+		{
+			BindAttributeDefaultsTable(*CurveTable);
+		}
+	}
+	return true;
+}
+
+bool UKaosAbilitySystemGlobals::ComputeAttributeDefaultsSourceStamp(uint32& OutSourceStamp) const
+{
+	// The saved package hashes recorded by the asset registry identify the table contents without loading them
+	const IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+
+	uint32 SourceStamp = 0;
+	auto StampValue = [&SourceStamp](const auto& Value) { SourceStamp = FCrc::MemCrc32(&Value, sizeof(Value), SourceStamp); };
+	StampValue(AttributeDefaultsInterpolation);
+	StampValue(AttributeDefaultsExtrapolation);
+	StampValue(AttributeDefaultsMaxLevel);
+
+	const TArray<FSoftObjectPath> TablePaths = GetGlobalAttributeSetDefaultsTablePaths();
+	if (TablePaths.IsEmpty())
+	{
+		return false;
+	}
+
+	for (const FSoftObjectPath& TablePath : TablePaths)
+	{
+		const TOptional<FAssetPackageData> PackageData = AssetRegistry.GetAssetPackageDataCopy(TablePath.GetLongPackageFName());
+		if (!PackageData.IsSet())
+		{
+			return false;
+		}
+
+		SourceStamp = FCrc::StrCrc32(*TablePath.ToString(), SourceStamp);
+		StampValue(PackageData->GetPackageSavedHash());
+	}
+
+	OutSourceStamp = SourceStamp;
+	return true;
+}
+
+void UKaosAbilitySystemGlobals::BindAttributeDefaultsTable(UCurveTable& CurveTable)
+{
+	CurveTable.OnCurveTableChanged().RemoveAll(this);
+	CurveTable.OnCurveTableChanged().AddUObject(this, &UKaosAbilitySystemGlobals::OnAttributeDefaultsTableChanged, TWeakObjectPtr<UCurveTable>(&CurveTable));
+}
+
+void UKaosAbilitySystemGlobals::OnEndLoadPackage(const FEndLoadPackageContext& Context)
+{
+	const TArray<FSoftObjectPath> TablePaths = GetGlobalAttributeSetDefaultsTablePaths();
+	for (const UPackage* Package : Context.LoadedPackages)
+	{
+		for (const FSoftObjectPath& TablePath : TablePaths)
+		{
+			if (Package && Package->GetFName() == TablePath.GetLongPackageFName())
+			{
+				if (UCurveTable* CurveTable = Cast<UCurveTable>(TablePath.ResolveObject()))
+				{
+					BindAttributeDefaultsTable(*CurveTable);
+				}
+			}
+		}
+	}
+}
+
+void UKaosAbilitySystemGlobals::ReloadAttributeDefaultsTable(const UCurveTable* CurveTable)
+{
+	FKaosAttributeSetInitter* Initter = GetKaosAttributeSetInitter();
+	if (!CurveTable || !Initter)
+	{
+		return;
+	}
+
+	// Cooked defaults keep no per table data, a changed table (i.e. a hotfix) no longer matches the file and every table has to be loaded and parsed
+	const bool bFullReload = Initter->IsUsingCookedDefaults();
+	TSet<FName> AffectedGroups;
+	if (bFullReload)
+	{
+		FCoreUObjectDelegates::OnEndLoadPackage.Remove(EndLoadPackageHandle);
+		EndLoadPackageHandle.Reset();
+		bParseAttributeDefaultsTables = true;
+		InitAttributeDefaults();
+		Initter = GetKaosAttributeSetInitter();
+		UE_LOG(LogKaosUtilities, Log, TEXT("Reloaded all attribute defaults after %s changed"), *CurveTable->GetName());
+	}
+	else
+	{
+		Initter->ReloadAttributeSetData(CurveTable, AffectedGroups);
+		FlushCachedModifierMagnitudes();
+		UE_LOG(LogKaosUtilities, Log, TEXT("Reloaded attribute defaults from %s, %d group(s) affected"), *CurveTable->GetName(), AffectedGroups.Num());
+	}
+
+	if (!bReapplyReloadedAttributeDefaults || (!bFullReload && AffectedGroups.IsEmpty()))
+	{
+		return;
+	}
+
+	// Reloads are a development workflow, walking every component is fine here
+	TArray<FKaosAttributeSetInitRequest> Requests;
+	for (TObjectIterator<UKaosAbilitySystemComponent> It; It; ++It)
+	{
+		UKaosAbilitySystemComponent* AbilitySystemComponent = *It;
+		if (AbilitySystemComponent->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) || !AbilitySystemComponent->IsOwnerActorAuthoritative())
+		{
+			continue;
+		}
+
+		if (bFullReload || AffectedGroups.Contains(AbilitySystemComponent->GetAttributeDefaultsGroup()))
+		{
+			Requests.Add({ AbilitySystemComponent, AbilitySystemComponent->GetAttributeDefaultsGroup(), AbilitySystemComponent->GetAttributeDefaultsLevel() });
+		}
+	}
+	Initter->InitAttributeSetDefaultsBatch(Requests, false);
+}
+
+bool UKaosAbilitySystemGlobals::WriteCookedAttributeDefaults() const
+{
+	if (CookedAttributeDefaultsPath.IsEmpty())
+	{
+		UE_LOG(LogKaosUtilities, Warning, TEXT("CookedAttributeDefaultsPath is not configured, cooked attribute defaults were not written"));
+		return false;
+	}
+
+	const FString Filename = GetCookedAttributeDefaultsFilename();
+	const FKaosAttributeSetInitter* Initter = GetKaosAttributeSetInitter();
+	if (!Initter || Initter->IsUsingCookedDefaults())
+	{
+		UE_LOG(LogKaosUtilities, Warning, TEXT("Attribute defaults were not parsed from curve tables, cooked attribute defaults were not written"));
+		return false;
+	}
+
+	uint32 SourceStamp = 0;
+	if (!ComputeAttributeDefaultsSourceStamp(SourceStamp))
+	{
+		UE_LOG(LogKaosUtilities, Warning, TEXT("The asset registry has no package data for the attribute defaults tables, cooked attribute defaults were not written"));
+		return false;
+	}
+
+	const bool bWritten = Initter->WriteCookedDefaults(Filename, SourceStamp);
+	UE_LOG(LogKaosUtilities, Log, TEXT("%s cooked attribute defaults %s"), bWritten ? TEXT("Wrote") : TEXT("Failed to write"), *Filename);
+	return bWritten;
+}
+
+FString UKaosAbilitySystemGlobals::GetCookedAttributeDefaultsFilename() const
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), CookedAttributeDefaultsPath);
+}
+
+void UKaosAbilitySystemGlobals::OnAttributeDefaultsTableChanged(TWeakObjectPtr<UCurveTable> CurveTable)
+{
+	ReloadAttributeDefaultsTable(CurveTable.Get());
+}
+
+bool FKaosCachedModifierMagnitudes::CanApplyTo(const UAbilitySystemComponent& AbilitySystemComponent) const
+{
+	for (const TPair<FGameplayAttribute, float>& AdditiveMagnitude : AdditiveMagnitudes)
+	{
+		const UAttributeSet* Set = AbilitySystemComponent.GetAttributeSet(AdditiveMagnitude.Key.GetAttributeSetClass());
+		const float CurrentValue = AdditiveMagnitude.Key.GetNumericValueChecked(Set);
+
+		if (CurrentValue + AdditiveMagnitude.Value < 0.f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool UKaosAbilitySystemGlobals::CanApplyAttributeModifiers(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayEffectSpec& EffectSpec)
+{
+	if (!EffectSpec.Def)
+	{
+		return true;
+	}
+
+	// The magnitude cache lives on the Kaos globals, projects using another globals class always evaluate the spec
+	if (UKaosAbilitySystemGlobals* KaosGlobals = Cast<UKaosAbilitySystemGlobals>(&UAbilitySystemGlobals::Get()))
+	{
+		const FKaosCachedModifierMagnitudes& CachedMagnitudes = KaosGlobals->GetCachedModifierMagnitudes(EffectSpec.Def, EffectSpec.GetLevel());
+		if (CachedMagnitudes.bIsStatic)
+		{
+			return CachedMagnitudes.CanApplyTo(AbilitySystemComponent);
+		}
+	}
+
+	// Dynamic magnitudes need evaluating against the spec, do it on a copy so the callers spec is left untouched
+	FGameplayEffectSpec EvaluatedSpec(EffectSpec);
+	EvaluatedSpec.CalculateModifierMagnitudes();
+
+	for (int32 ModIdx = 0; ModIdx < EvaluatedSpec.Modifiers.Num(); ++ModIdx)
+	{
+		const FGameplayModifierInfo& ModDef = EvaluatedSpec.Def->Modifiers[ModIdx];
+		const FModifierSpec& ModSpec = EvaluatedSpec.Modifiers[ModIdx];
+
+		// It only makes sense to check additive operators
+		if (ModDef.ModifierOp == EGameplayModOp::Additive)
+		{
+			if (!ModDef.Attribute.IsValid())
+			{
+				continue;
+			}
+			const UAttributeSet* Set = AbilitySystemComponent.GetAttributeSet(ModDef.Attribute.GetAttributeSetClass());
+			const float CurrentValue = ModDef.Attribute.GetNumericValueChecked(Set);
+			const float CostValue = ModSpec.GetEvaluatedMagnitude();
+
+			if (CurrentValue + CostValue < 0.f)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+const FKaosCachedModifierMagnitudes& UKaosAbilitySystemGlobals::GetCachedModifierMagnitudes(const UGameplayEffect* Effect, float Level)
+{
+	check(Effect);
+
+	const TPair<TObjectKey<UGameplayEffect>, float> Key(Effect, Level);
+	if (const FKaosCachedModifierMagnitudes* Cached = CachedModifierMagnitudes.Find(Key))
+	{
+		return *Cached;
+	}
+
+	FKaosCachedModifierMagnitudes& Cached = CachedModifierMagnitudes.Add(Key);
+	Cached.bIsStatic = true;
+	for (const FGameplayModifierInfo& ModDef : Effect->Modifiers)
+	{
+		// It only makes sense to check additive operators
+		if (ModDef.ModifierOp != EGameplayModOp::Additive || !ModDef.Attribute.IsValid())
+		{
+			continue;
+		}
+
+		float Magnitude = 0.f;
+		if (!ModDef.ModifierMagnitude.GetStaticMagnitudeIfPossible(Level, Magnitude))
+		{
+			Cached.bIsStatic = false;
+			Cached.AdditiveMagnitudes.Empty();
+			break;
+		}
+		Cached.AdditiveMagnitudes.Emplace(ModDef.Attribute, Magnitude);
+	}
+	return Cached;
+}
+
+void UKaosAbilitySystemGlobals::FlushCachedModifierMagnitudes()
+{
+	CachedModifierMagnitudes.Reset();
 }
 
 TSharedPtr<FKaosAttributeBasics> UKaosAbilitySystemGlobals::AllocKaosAttributeBasics() const
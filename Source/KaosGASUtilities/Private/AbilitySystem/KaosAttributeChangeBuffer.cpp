@@ -0,0 +1,50 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "AbilitySystem/KaosAttributeChangeBuffer.h"
+
+FKaosAttributeChangeBuffer::FKaosAttributeChangeBuffer(uint32 Capacity)
+	// The queue keeps one slot free to tell full from empty
+	: Records(FMath::Max<uint32>(Capacity, 1) + 1)
+{
+}
+
+bool FKaosAttributeChangeBuffer::Record(const FKaosAttributeChangeRecord& ChangeRecord)
+{
+	if (!Records.Enqueue(ChangeRecord))
+	{
+		NumDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+int32 FKaosAttributeChangeBuffer::Drain(TArray<FKaosAttributeChangeRecord>& OutRecords)
+{
+	const int32 StartNum = OutRecords.Num();
+	OutRecords.Reserve(StartNum + Records.Count());
+
+	FKaosAttributeChangeRecord ChangeRecord;
+	while (Records.Dequeue(ChangeRecord))
+	{
+		OutRecords.Add(MoveTemp(ChangeRecord));
+	}
+	return OutRecords.Num() - StartNum;
+}
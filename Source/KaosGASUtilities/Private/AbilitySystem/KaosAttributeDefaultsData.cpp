@@ -0,0 +1,326 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "AbilitySystem/KaosAttributeDefaultsData.h"
+
+#include "AttributeSet.h"
+#include "KaosUtilitiesLogging.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+FKaosAttributeDefaultsData::FKaosAttributeDefaultsData() = default;
+FKaosAttributeDefaultsData::~FKaosAttributeDefaultsData() = default;
+
+bool FKaosAttributeDefaultsData::InitializeFromMemory(TArray<uint8>&& InData)
+{
+	Reset();
+	HeapData = MoveTemp(InData);
+	return ResolveLayout();
+}
+
+bool FKaosAttributeDefaultsData::InitializeFromFile(const FString& Filename)
+{
+	Reset();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FOpenMappedResult MappedResult = PlatformFile.OpenMappedEx(*Filename);
+	if (MappedResult.HasValue())
+	{
+		MappedFile = MappedResult.StealValue();
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	if (!MappedRegion.IsValid())
+	{
+		MappedFile.Reset();
+		if (!FFileHelper::LoadFileToArray(HeapData, *Filename, FILEREAD_Silent))
+		{
+			UE_LOG(LogKaosUtilities, Warning, TEXT("Unable to read cooked attribute defaults %s"), *Filename);
+			return false;
+		}
+	}
+
+	if (!ResolveLayout())
+	{
+		UE_LOG(LogKaosUtilities, Warning, TEXT("Cooked attribute defaults %s are invalid or out of date"), *Filename);
+		Reset();
+		return false;
+	}
+
+	UE_LOG(LogKaosUtilities, Log, TEXT("Loaded cooked attribute defaults %s (%s)"), *Filename, IsMapped() ? TEXT("mapped") : TEXT("heap"));
+	return true;
+}
+
+int32 FKaosAttributeDefaultsData::FindGroup(FName GroupName) const
+{
+	const int32* GroupIndex = GroupIndices.Find(GroupName);
+	return GroupIndex ? *GroupIndex : INDEX_NONE;
+}
+
+int32 FKaosAttributeDefaultsData::FindColumn(int32 GroupIndex, const UClass* SetClass, const FProperty* Property) const
+{
+	const int32* ColumnIndex = ColumnIndices.Find(MakeTuple(GroupIndex, SetClass, Property));
+	return ColumnIndex ? *ColumnIndex : INDEX_NONE;
+}
+
+bool FKaosAttributeDefaultsData::ResolveLayout()
+{
+	const uint8* Data = MappedRegion.IsValid() ? MappedRegion->GetMappedPtr() : HeapData.GetData();
+	const int64 DataSize = MappedRegion.IsValid() ? MappedRegion->GetMappedSize() : HeapData.Num();
+	if (!Data || DataSize < static_cast<int64>(sizeof(FHeader)))
+	{
+		return false;
+	}
+
+	const FHeader& Header = *reinterpret_cast<const FHeader*>(Data);
+	if (Header.Magic != FileMagic || Header.Version != FileVersion)
+	{
+		return false;
+	}
+	SourceHash = Header.SourceHash;
+
+	int64 Offset = sizeof(FHeader);
+	auto TakeSection = [Data, DataSize, &Offset](auto& OutView, uint32 Num, int64 PaddedBytes = 0)
+	{
+		using FElement = typename std::remove_reference_t<decltype(OutView)>::ElementType;
+		const int64 Bytes = FMath::Max(static_cast<int64>(Num) * static_cast<int64>(sizeof(FElement)), PaddedBytes);
+		if (Offset + Bytes > DataSize)
+		{
+			return false;
+		}
+		OutView = MakeArrayView(reinterpret_cast<const FElement*>(Data + Offset), Num);
+		Offset += Bytes;
+		return true;
+	};
+
+	if (!TakeSection(Strings, Header.NumStrings)
+		|| !TakeSection(StringData, Header.StringDataSize, Align(Header.StringDataSize, 4))
+		|| !TakeSection(Groups, Header.NumGroups)
+		|| !TakeSection(Sets, Header.NumSets)
+		|| !TakeSection(PropertyEntries, Header.NumProperties)
+		|| !TakeSection(GroupSets, Header.NumGroupSets)
+		|| !TakeSection(Columns, Header.NumColumns)
+		|| !TakeSection(Values, Header.NumValues))
+	{
+		return false;
+	}
+
+	// Check the tables index each other correctly, values are left alone so loading does not touch every page
+	for (const FStringEntry& String : Strings)
+	{
+		if (static_cast<uint64>(String.Offset) + String.Length > Header.StringDataSize)
+		{
+			return false;
+		}
+	}
+	for (const FGroupEntry& Group : Groups)
+	{
+		if (Group.NameIndex >= Header.NumStrings || static_cast<uint64>(Group.FirstGroupSet) + Group.NumGroupSets > Header.NumGroupSets)
+		{
+			return false;
+		}
+	}
+	for (const FGroupSetEntry& GroupSet : GroupSets)
+	{
+		if (GroupSet.SetIndex >= Header.NumSets || static_cast<uint64>(GroupSet.FirstColumn) + GroupSet.NumColumns > Header.NumColumns)
+		{
+			return false;
+		}
+	}
+	for (const FColumnEntry& Column : Columns)
+	{
+		if (Column.PropertyIndex >= Header.NumProperties || static_cast<uint64>(Column.FirstValue) + Column.NumLevels > Header.NumValues)
+		{
+			return false;
+		}
+	}
+
+	GroupIndices.Reserve(Groups.Num());
+	for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex)
+	{
+		GroupIndices.Add(FName(*GetString(Groups[GroupIndex].NameIndex)), GroupIndex);
+	}
+
+	SetClasses.Reserve(Sets.Num());
+	for (const FSetEntry& Set : Sets)
+	{
+		UClass* SetClass = Set.PathIndex < Header.NumStrings ? LoadObject<UClass>(nullptr, *GetString(Set.PathIndex)) : nullptr;
+		if (SetClass && !SetClass->IsChildOf(UAttributeSet::StaticClass()))
+		{
+			SetClass = nullptr;
+		}
+		SetClasses.Add(SetClass);
+	}
+
+	Properties.Reserve(PropertyEntries.Num());
+	for (const FPropertyEntry& PropertyEntry : PropertyEntries)
+	{
+		UClass* SetClass = PropertyEntry.SetIndex < Header.NumSets ? SetClasses[PropertyEntry.SetIndex] : nullptr;
+		FProperty* Property = SetClass && PropertyEntry.NameIndex < Header.NumStrings ? FindFProperty<FProperty>(SetClass, *GetString(PropertyEntry.NameIndex)) : nullptr;
+		if (!Property)
+		{
+			UE_LOG(LogKaosUtilities, Warning, TEXT("Cooked attribute defaults reference a missing attribute, its values will be skipped"));
+		}
+		Properties.Add(Property);
+	}
+
+	ColumnIndices.Reserve(Columns.Num());
+	for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex)
+	{
+		for (const FGroupSetEntry& GroupSet : GetGroupSets(GroupIndex))
+		{
+			for (uint32 ColumnIndex = GroupSet.FirstColumn; ColumnIndex < GroupSet.FirstColumn + GroupSet.NumColumns; ++ColumnIndex)
+			{
+				ColumnIndices.Add(MakeTuple(GroupIndex, SetClasses[GroupSet.SetIndex], Properties[Columns[ColumnIndex].PropertyIndex]), ColumnIndex);
+			}
+		}
+	}
+
+	return true;
+}
+
+FString FKaosAttributeDefaultsData::GetString(uint32 StringIndex) const
+{
+	const FStringEntry& String = Strings[StringIndex];
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(StringData.GetData() + String.Offset), String.Length);
+	return FString(Converted.Length(), Converted.Get());
+}
+
+void FKaosAttributeDefaultsData::Reset()
+{
+	Strings = {};
+	StringData = {};
+	Groups = {};
+	Sets = {};
+	PropertyEntries = {};
+	GroupSets = {};
+	Columns = {};
+	Values = {};
+	GroupIndices.Reset();
+	ColumnIndices.Reset();
+	SetClasses.Reset();
+	Properties.Reset();
+	SourceHash = 0;
+
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	HeapData.Empty();
+}
+
+void FKaosAttributeDefaultsWriter::BeginGroup(FName GroupName)
+{
+	FKaosAttributeDefaultsData::FGroupEntry& Group = Groups.AddDefaulted_GetRef();
+	Group.NameIndex = FindOrAddString(GroupName.ToString());
+	Group.NumLevels = 0;
+	Group.FirstGroupSet = GroupSets.Num();
+	Group.NumGroupSets = 0;
+}
+
+void FKaosAttributeDefaultsWriter::AddColumn(const UClass* SetClass, const FProperty* Property, TConstArrayView<float> LevelValues)
+{
+	check(Groups.Num() > 0 && SetClass && Property);
+
+	const uint32 SetIndex = FindOrAddSet(SetClass);
+	FKaosAttributeDefaultsData::FGroupEntry& Group = Groups.Last();
+	if (Group.NumGroupSets == 0 || GroupSets.Last().SetIndex != SetIndex)
+	{
+		FKaosAttributeDefaultsData::FGroupSetEntry& GroupSet = GroupSets.AddDefaulted_GetRef();
+		GroupSet.SetIndex = SetIndex;
+		GroupSet.FirstColumn = Columns.Num();
+		GroupSet.NumColumns = 0;
+		++Group.NumGroupSets;
+	}
+
+	Columns.Add({ FindOrAddProperty(SetIndex, Property), static_cast<uint32>(Values.Num()), static_cast<uint32>(LevelValues.Num()) });
+	Values.Append(LevelValues.GetData(), LevelValues.Num());
+	++GroupSets.Last().NumColumns;
+	Group.NumLevels = FMath::Max<uint32>(Group.NumLevels, LevelValues.Num());
+}
+
+void FKaosAttributeDefaultsWriter::Write(TArray<uint8>& OutData, uint32 SourceHash) const
+{
+	TArray<FKaosAttributeDefaultsData::FStringEntry> StringEntries;
+	TArray<uint8> StringData;
+	for (const FString& String : Strings)
+	{
+		const FTCHARToUTF8 Converted(*String);
+		StringEntries.Add({ static_cast<uint32>(StringData.Num()), static_cast<uint32>(Converted.Length()) });
+		StringData.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	}
+
+	FKaosAttributeDefaultsData::FHeader Header;
+	Header.Magic = FKaosAttributeDefaultsData::FileMagic;
+	Header.Version = FKaosAttributeDefaultsData::FileVersion;
+	Header.NumStrings = StringEntries.Num();
+	Header.StringDataSize = StringData.Num();
+	Header.NumGroups = Groups.Num();
+	Header.NumSets = Sets.Num();
+	Header.NumProperties = Properties.Num();
+	Header.NumGroupSets = GroupSets.Num();
+	Header.NumColumns = Columns.Num();
+	Header.NumValues = Values.Num();
+	Header.SourceHash = SourceHash;
+
+	// Keep every section 4 byte aligned, they are read in place
+	StringData.SetNumZeroed(Align(StringData.Num(), 4));
+
+	OutData.Reset();
+	OutData.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	OutData.Append(reinterpret_cast<const uint8*>(StringEntries.GetData()), StringEntries.NumBytes());
+	OutData.Append(StringData);
+	OutData.Append(reinterpret_cast<const uint8*>(Groups.GetData()), Groups.NumBytes());
+	OutData.Append(reinterpret_cast<const uint8*>(Sets.GetData()), Sets.NumBytes());
+	OutData.Append(reinterpret_cast<const uint8*>(Properties.GetData()), Properties.NumBytes());
+	OutData.Append(reinterpret_cast<const uint8*>(GroupSets.GetData()), GroupSets.NumBytes());
+	OutData.Append(reinterpret_cast<const uint8*>(Columns.GetData()), Columns.NumBytes());
+	OutData.Append(reinterpret_cast<const uint8*>(Values.GetData()), Values.NumBytes());
+}
+
+uint32 FKaosAttributeDefaultsWriter::FindOrAddString(const FString& String)
+{
+	if (const uint32* StringIndex = StringIndices.Find(String))
+	{
+		return *StringIndex;
+	}
+	return StringIndices.Add(String, Strings.Add(String));
+}
+
+uint32 FKaosAttributeDefaultsWriter::FindOrAddSet(const UClass* SetClass)
+{
+	if (const uint32* SetIndex = SetIndices.Find(SetClass))
+	{
+		return *SetIndex;
+	}
+
+	const uint32 SetIndex = Sets.Add({ FindOrAddString(SetClass->GetPathName()) });
+	return SetIndices.Add(SetClass, SetIndex);
+}
+
+uint32 FKaosAttributeDefaultsWriter::FindOrAddProperty(uint32 SetIndex, const FProperty* Property)
+{
+	if (const uint32* PropertyIndex = PropertyIndices.Find(Property))
+	{
+		return *PropertyIndex;
+	}
+
+	const uint32 PropertyIndex = Properties.Add({ SetIndex, FindOrAddString(Property->GetName()) });
+	return PropertyIndices.Add(Property, PropertyIndex);
+}
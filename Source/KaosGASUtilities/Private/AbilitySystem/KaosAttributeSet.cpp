@@ -22,6 +22,7 @@
 
 #include "AbilitySystemLog.h"
 #include "GameplayEffectExtension.h"
+#include "Misc/FileHelper.h"
 #include "AbilitySystem/KaosAbilitySystemComponent.h"
 #include "AbilitySystem/KaosAbilitySystemGlobals.h"
 
@@ -39,13 +40,20 @@ TSubclassOf<UAttributeSet> CommonFindBestAttributeClass(TArray<TSubclassOf<UAttr
 	return nullptr;
 }
 
+FKaosAttributeSetInitter::FKaosAttributeSetInitter(EKaosAttributeDefaultsInterpolation InInterpolation, EKaosAttributeDefaultsExtrapolation InExtrapolation, int32 InMaxLevel)
+	: Interpolation(InInterpolation)
+	, Extrapolation(InExtrapolation)
+	, MaxLevel(InMaxLevel)
+{
+}
+
 /**
  *	Transforms CurveTable data into format more efficient to read at runtime.
  *	UCurveTable requires string parsing to map to GroupName/AttributeSet/Attribute
  *	Each curve in the table represents a *single attribute's values for all levels*.
- *	At runtime, we want *all attribute values at given level*.
+ *	At runtime, we want *all attribute values at given level* without evaluating curves.
  *
- *	This code assumes that your curve data starts with a key of 1 and increases by 1 with each key.
+ *	Keys may be sparse, the curve is evaluated at every level from 1 into a lookup table.
  */
 void FKaosAttributeSetInitter::PreloadAttributeSetData(const TArray<UCurveTable*>& CurveData)
 {
@@ -54,121 +62,247 @@ void FKaosAttributeSetInitter::PreloadAttributeSetData(const TArray<UCurveTable*
 		return;
 	}
 
+	TArray<TSubclassOf<UAttributeSet>> ClassList;
+	GetAttributeSetClasses(ClassList);
+
 	/**
-	 *	Get list of AttributeSet classes loaded
+	 *	Loop through CurveData table and build sets of Defaults that keyed off of Name + Level
 	 */
+	for (const UCurveTable* CurTable : CurveData)
+	{
+		TableOrder.AddUnique(TObjectKey<UCurveTable>(CurTable));
+		PreloadCurveTable(CurTable, ClassList, nullptr);
+	}
+
+	CompileDefaults();
+}
+
+void FKaosAttributeSetInitter::ReloadAttributeSetData(const UCurveTable* CurveTable, TSet<FName>& OutAffectedGroups)
+{
+	check(CurveTable);
+
+	// Drop everything the table contributed, groups it no longer mentions are affected too. Columns other tables also define keep their values.
+	const TObjectKey<UCurveTable> SourceTable(CurveTable);
+	for (TPair<FName, FKaosAttributeSetDefaultsCollection>& DefaultCollection : Defaults)
+	{
+		for (auto It = DefaultCollection.Value.DataMap.CreateIterator(); It; ++It)
+		{
+			TArray<FKaosAttributeDefaultColumn>& Columns = It.Value().Columns;
+			for (int32 ColumnIndex = Columns.Num() - 1; ColumnIndex >= 0; --ColumnIndex)
+			{
+				TArray<FKaosAttributeDefaultContribution, TInlineAllocator<1>>& Contributions = Columns[ColumnIndex].Contributions;
+				if (Contributions.RemoveAll([&SourceTable](const FKaosAttributeDefaultContribution& Contribution) { return Contribution.SourceTable == SourceTable; }) > 0)
+				{
+					OutAffectedGroups.Add(DefaultCollection.Key);
+				}
+				if (Contributions.IsEmpty())
+				{
+					Columns.RemoveAt(ColumnIndex);
+				}
+			}
+			if (Columns.IsEmpty())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
 
 	TArray<TSubclassOf<UAttributeSet>> ClassList;
+	GetAttributeSetClasses(ClassList);
+	PreloadCurveTable(CurveTable, ClassList, &OutAffectedGroups);
+
+	CompileDefaults();
+}
+
+void FKaosAttributeSetInitter::GetAttributeSetClasses(TArray<TSubclassOf<UAttributeSet>>& OutClassList)
+{
+	/**
+	 *	Get list of AttributeSet classes loaded
+	 */
 	for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
 	{
 		UClass* TestClass = *ClassIt;
 		if (TestClass->IsChildOf(UAttributeSet::StaticClass()))
 		{
-			ClassList.Add(TestClass);
+			OutClassList.Add(TestClass);
 		}
 	}
+}
 
-	/**
-	 *	Loop through CurveData table and build sets of Defaults that keyed off of Name + Level
-	 */
-	for (const UCurveTable* CurTable : CurveData)
+int32 FKaosAttributeSetInitter::GetTableOrder(TObjectKey<UCurveTable> CurveTable)
+{
+	return TableOrder.AddUnique(CurveTable);
+}
+
+void FKaosAttributeSetInitter::PreloadCurveTable(const UCurveTable* CurTable, const TArray<TSubclassOf<UAttributeSet>>& ClassList, TSet<FName>* OutAffectedGroups)
+{
+	const TObjectKey<UCurveTable> SourceTable(CurTable);
+	const int32 SourceTableOrder = GetTableOrder(SourceTable);
+	for (const TPair<FName, FRealCurve*>& CurveRow : CurTable->GetRowMap())
 	{
-		for (const TPair<FName, FRealCurve*>& CurveRow : CurTable->GetRowMap())
+		FString RowName = CurveRow.Key.ToString();
+		FString ClassName;
+		FString SetName;
+		FString AttributeName;
+		FString Temp;
+
+		RowName.Split(TEXT("."), &Temp, &AttributeName, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+		Temp.Split(TEXT("."), &ClassName, &SetName, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+
+		if (!ensure(!ClassName.IsEmpty() && !SetName.IsEmpty() && !AttributeName.IsEmpty()))
 		{
-			FString RowName = CurveRow.Key.ToString();
-			FString ClassName;
-			FString SetName;
-			FString AttributeName;
-			FString Temp;
+			ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Unable to parse row %s in %s"), *RowName, *CurTable->GetName());
+			continue;
+		}
 
-			RowName.Split(TEXT("."), &Temp, &AttributeName, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
-			Temp.Split(TEXT("."), &ClassName, &SetName, ESearchCase::IgnoreCase, ESearchDir::FromEnd);
+		// Find the AttributeSet
 
-			if (!ensure(!ClassName.IsEmpty() && !SetName.IsEmpty() && !AttributeName.IsEmpty()))
-			{
-				ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Unable to parse row %s in %s"), *RowName, *CurTable->GetName());
-				continue;
-			}
+		TSubclassOf<UAttributeSet> Set = CommonFindBestAttributeClass(ClassList, SetName);
+		if (!Set)
+		{
+			// This is ok, we may have rows in here that don't correspond directly to attributes
+			ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Unable to match AttributeSet from %s (row: %s)"), *SetName, *RowName);
+			continue;
+		}
 
-			// Find the AttributeSet
+		// Find the FProperty
+		FProperty* Property = FindFProperty<FProperty>(*Set, *AttributeName);
+		if (!IsSupportedProperty(Property))
+		{
+			ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Unable to match Attribute from %s (row: %s)"), *AttributeName, *RowName);
+			continue;
+		}
 
-			TSubclassOf<UAttributeSet> Set = CommonFindBestAttributeClass(ClassList, SetName);
-			if (!Set)
-			{
-				// This is ok, we may have rows in here that don't correspond directly to attributes
-				ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Unable to match AttributeSet from %s (row: %s)"), *SetName, *RowName);
-				continue;
-			}
+		const FRealCurve* Curve = CurveRow.Value;
+		FName ClassFName = FName(*ClassName);
+		FKaosAttributeSetDefaultsCollection& DefaultCollection = Defaults.FindOrAdd(ClassFName);
+		if (OutAffectedGroups)
+		{
+			OutAffectedGroups->Add(ClassFName);
+		}
 
-			// Find the FProperty
-			FProperty* Property = FindFProperty<FProperty>(*Set, *AttributeName);
-			if (!IsSupportedProperty(Property))
+		// Check our curve to make sure the keys match the expected format, they do not need to be on every level
+		bool bShouldSkip = Curve->GetNumKeys() == 0;
+		for (auto KeyIter = Curve->GetKeyHandleIterator(); KeyIter; ++KeyIter)
+		{
+			const FKeyHandle& KeyHandle = *KeyIter;
+			if (KeyHandle == FKeyHandle::Invalid())
 			{
-				ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Unable to match Attribute from %s (row: %s)"), *AttributeName, *RowName);
-				continue;
+				ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Data contains an invalid key handle (row: %s)"), *RowName);
+				bShouldSkip = true;
+				break;
 			}
 
-			const FRealCurve* Curve = CurveRow.Value;
-			FName ClassFName = FName(*ClassName);
-			FKaosAttributeSetDefaultsCollection& DefaultCollection = Defaults.FindOrAdd(ClassFName);
-
-			// Check our curve to make sure the keys match the expected format
-			int32 ExpectedLevel = 1;
-			bool bShouldSkip = false;
-			for (auto KeyIter = Curve->GetKeyHandleIterator(); KeyIter; ++KeyIter)
+			if (Curve->GetKeyTime(KeyHandle) < 1.f)
 			{
-				const FKeyHandle& KeyHandle = *KeyIter;
-				if (KeyHandle == FKeyHandle::Invalid())
-				{
-					ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Data contains an invalid key handle (row: %s)"), *RowName);
-					bShouldSkip = true;
-					break;
-				}
+				ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Keys are expected to be at level 1 or above (row: %s)"), *RowName);
+				bShouldSkip = true;
+				break;
+			}
+		}
 
-				const int32 Level = Curve->GetKeyTimeValuePair(KeyHandle).Key;
-				if (ExpectedLevel != Level)
-				{
-					ABILITY_LOG(Verbose, TEXT("FAttributeSetInitterDiscreteLevels::PreloadAttributeSetData Keys are expected to start at 1 and increase by 1 for every key (row: %s)"), *RowName);
-					bShouldSkip = true;
-					break;
-				}
+		if (bShouldSkip)
+		{
+			continue;
+		}
 
-				++ExpectedLevel;
-			}
+		FKaosAttributeSetDefaults* SetDefaults = DefaultCollection.DataMap.Find(Set);
+		if (SetDefaults == nullptr)
+		{
+			ABILITY_LOG(Verbose, TEXT("Initializing new default set for %s. PropertySize: %d.. DefaultSize: %d"), *Set->GetName(), Set->GetPropertiesSize(), UAttributeSet::StaticClass()->GetPropertiesSize());
 
-			if (bShouldSkip)
-			{
-				continue;
-			}
+			SetDefaults = &DefaultCollection.DataMap.Add(Set);
+		}
 
-			const int32 LastLevel = Curve->GetKeyTime(Curve->GetLastKeyHandle());
-			DefaultCollection.LevelData.SetNum(FMath::Max(LastLevel, DefaultCollection.LevelData.Num()));
+		FKaosAttributeDefaultColumn* Column = SetDefaults->Columns.FindByPredicate([Property](const FKaosAttributeDefaultColumn& Existing) { return Existing.Property == Property; });
+		if (Column == nullptr)
+		{
+			Column = &SetDefaults->Columns.AddDefaulted_GetRef();
+			Column->Property = Property;
+		}
 
-			//At this point we know the Name of this "class"/"group", the AttributeSet, and the Property Name. Now loop through the values on the curve to get the attribute default value at each level.
-			for (auto KeyIter = Curve->GetKeyHandleIterator(); KeyIter; ++KeyIter)
-			{
-				const FKeyHandle& KeyHandle = *KeyIter;
+		// A later row of the same table overrides the earlier one, a later table overrides earlier tables whichever of them was loaded last
+		int32 ContributionIndex = 0;
+		while (ContributionIndex < Column->Contributions.Num() && GetTableOrder(Column->Contributions[ContributionIndex].SourceTable) < SourceTableOrder)
+		{
+			++ContributionIndex;
+		}
+		if (ContributionIndex == Column->Contributions.Num() || Column->Contributions[ContributionIndex].SourceTable != SourceTable)
+		{
+			Column->Contributions.Insert(FKaosAttributeDefaultContribution{ SourceTable }, ContributionIndex);
+		}
 
-				const TPair<float, float> LevelValuePair = Curve->GetKeyTimeValuePair(KeyHandle);
-				int32 Level = LevelValuePair.Key;
-				const float Value = LevelValuePair.Value;
+		//At this point we know the Name of this "class"/"group", the AttributeSet, and the Property Name. Now evaluate the curve to get the attribute default value at each level.
+		EvaluateLevelValues(*Curve, Column->Contributions[ContributionIndex].LevelValues);
+	}
+}
 
-				FKaosAttributeSetDefaults& SetDefaults = DefaultCollection.LevelData[Level - 1];
+void FKaosAttributeSetInitter::EvaluateLevelValues(const FRealCurve& Curve, TArray<float>& OutLevelValues) const
+{
+	TArray<float, TInlineAllocator<16>> KeyLevels;
+	TArray<float, TInlineAllocator<16>> KeyValues;
+	for (auto KeyIter = Curve.GetKeyHandleIterator(); KeyIter; ++KeyIter)
+	{
+		const TPair<float, float> LevelValuePair = Curve.GetKeyTimeValuePair(*KeyIter);
+		KeyLevels.Add(LevelValuePair.Key);
+		KeyValues.Add(LevelValuePair.Value);
+	}
 
-				FKaosAttributeDefaultValueList* DefaultDataList = SetDefaults.DataMap.Find(Set);
-				if (DefaultDataList == nullptr)
-				{
-					ABILITY_LOG(Verbose, TEXT("Initializing new default set for %s[%d]. PropertySize: %d.. DefaultSize: %d"), *Set->GetName(), Level, Set->GetPropertiesSize(), UAttributeSet::StaticClass()->GetPropertiesSize());
+	const int32 NumKeys = KeyLevels.Num();
+	const int32 LastKeyLevel = FMath::FloorToInt32(KeyLevels.Last());
+	const int32 NumLevels = Extrapolation == EKaosAttributeDefaultsExtrapolation::None ? LastKeyLevel : FMath::Max(LastKeyLevel, MaxLevel);
 
-					DefaultDataList = &SetDefaults.DataMap.Add(Set);
-				}
+	// Slopes used to extend the curve past either end
+	const float FirstSlope = NumKeys > 1 ? (KeyValues[1] - KeyValues[0]) / (KeyLevels[1] - KeyLevels[0]) : 0.f;
+	const float LastSlope = NumKeys > 1 ? (KeyValues[NumKeys - 1] - KeyValues[NumKeys - 2]) / (KeyLevels[NumKeys - 1] - KeyLevels[NumKeys - 2]) : 0.f;
 
-				// Import curve value into default data
+	// Tangent at a key for the cubic mode, one sided at the ends
+	auto GetTangent = [&KeyLevels, &KeyValues, NumKeys](int32 KeyIndex)
+	{
+		const int32 Prev = FMath::Max(KeyIndex - 1, 0);
+		const int32 Next = FMath::Min(KeyIndex + 1, NumKeys - 1);
+		return Next > Prev ? (KeyValues[Next] - KeyValues[Prev]) / (KeyLevels[Next] - KeyLevels[Prev]) : 0.f;
+	};
+
+	OutLevelValues.SetNumUninitialized(NumLevels);
+	int32 Segment = 0;
+	for (int32 Level = 1; Level <= NumLevels; ++Level)
+	{
+		const float LevelTime = static_cast<float>(Level);
+		float Value;
+		if (LevelTime <= KeyLevels[0])
+		{
+			// Held even without extrapolation, as FRealCurve::Eval does before the first key
+			Value = Extrapolation == EKaosAttributeDefaultsExtrapolation::Linear ? KeyValues[0] + FirstSlope * (LevelTime - KeyLevels[0]) : KeyValues[0];
+		}
+		else if (LevelTime >= KeyLevels.Last())
+		{
+			Value = Extrapolation == EKaosAttributeDefaultsExtrapolation::Linear ? KeyValues.Last() + LastSlope * (LevelTime - KeyLevels.Last()) : KeyValues.Last();
+		}
+		else if (Interpolation == EKaosAttributeDefaultsInterpolation::Curve)
+		{
+			Value = Curve.Eval(LevelTime);
+		}
+		else
+		{
+			// Levels increase monotonically so the segment only ever moves forward
+			while (KeyLevels[Segment + 1] < LevelTime)
+			{
+				++Segment;
+			}
 
-				check(DefaultDataList);
-				DefaultDataList->AddPair(Property, Value);
+			const float SegmentLength = KeyLevels[Segment + 1] - KeyLevels[Segment];
+			const float Alpha = (LevelTime - KeyLevels[Segment]) / SegmentLength;
+			if (Interpolation == EKaosAttributeDefaultsInterpolation::Cubic)
+			{
+				Value = FMath::CubicInterp(KeyValues[Segment], GetTangent(Segment) * SegmentLength, KeyValues[Segment + 1], GetTangent(Segment + 1) * SegmentLength, Alpha);
+			}
+			else
+			{
+				Value = FMath::Lerp(KeyValues[Segment], KeyValues[Segment + 1], Alpha);
 			}
 		}
+		OutLevelValues[Level - 1] = Value;
 	}
 }
 
@@ -176,54 +310,43 @@ void FKaosAttributeSetInitter::InitAttributeSetDefaults(UAbilitySystemComponent*
 {
 	check(AbilitySystemComponent != nullptr);
 
-	const FKaosAttributeSetDefaultsCollection* Collection = Defaults.Find(GroupName);
-	if (!Collection)
+	const int32 GroupIndex = FindGroupIndex(GroupName);
+	if (GroupIndex == INDEX_NONE)
 	{
-		ABILITY_LOG(Warning, TEXT("Unable to find DefaultAttributeSet Group %s. Falling back to Defaults"), *GroupName.ToString());
-		Collection = Defaults.Find(FName(TEXT("Default")));
-		if (!Collection)
-		{
-			ABILITY_LOG(Error, TEXT("FAttributeSetInitterDiscreteLevels::InitAttributeSetDefaults Default DefaultAttributeSet not found! Skipping Initialization"));
-			return;
-		}
+		return;
 	}
 
-	if (!Collection->LevelData.IsValidIndex(Level - 1))
+	if (Level < 1 || Level > CompiledDefaults.GetNumLevels(GroupIndex))
 	{
-		// We could eventually extrapolate values outside of the max defined levels
+		// Past the last key with no extrapolation configured, see AttributeDefaultsExtrapolation
 		ABILITY_LOG(Warning, TEXT("Attribute defaults for Level %d are not defined! Skipping"), Level);
 		return;
 	}
 
-	const FKaosAttributeSetDefaults& SetDefaults = Collection->LevelData[Level - 1];
+	if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent))
+	{
+		KaosAbilitySystemComponent->SetAttributeDefaultsGroup(GroupName, Level);
+	}
+
 	for (const UAttributeSet* Set : AbilitySystemComponent->GetSpawnedAttributes())
 	{
 		if (!Set)
 		{
 			continue;
 		}
-		// Iterate to find the parent classes, as this could be a derived set
-		TSubclassOf<UAttributeSet> ParentClass;
-		for (ParentClass = Set->GetClass(); ParentClass ? ParentClass->GetSuperClass() : nullptr; ParentClass = ParentClass->GetSuperClass())
-		{
-			if (SetDefaults.DataMap.Contains(ParentClass))
-			{
-				break;
-			}
-		}
-		const FKaosAttributeDefaultValueList* DefaultDataList = SetDefaults.DataMap.Find(ParentClass);
-		if (DefaultDataList)
+
+		const FKaosAttributeDefaultsData::FGroupSetEntry* GroupSet = FindGroupSet(GroupIndex, Set);
+		if (GroupSet)
 		{
 			ABILITY_LOG(Log, TEXT("Initializing Set %s"), *Set->GetName());
 
-			for (auto& DataPair : DefaultDataList->List)
+			for (const FKaosAttributeDefaultsData::FColumnEntry& Column : CompiledDefaults.GetColumns(*GroupSet))
 			{
-				check(DataPair.Property);
-
-				if (Set->ShouldInitProperty(bInitialInit, DataPair.Property))
+				FProperty* Property = CompiledDefaults.GetProperty(Column.PropertyIndex);
+				if (Property && Level <= static_cast<int32>(Column.NumLevels) && Set->ShouldInitProperty(bInitialInit, Property))
 				{
-					FGameplayAttribute AttributeToModify(DataPair.Property);
-					AbilitySystemComponent->SetNumericAttributeBase(AttributeToModify, DataPair.Value);
+					FGameplayAttribute AttributeToModify(Property);
+					AbilitySystemComponent->SetNumericAttributeBase(AttributeToModify, CompiledDefaults.GetLevelValues(Column)[Level - 1]);
 				}
 			}
 		}
@@ -234,26 +357,19 @@ void FKaosAttributeSetInitter::InitAttributeSetDefaults(UAbilitySystemComponent*
 
 void FKaosAttributeSetInitter::ApplyAttributeDefault(UAbilitySystemComponent* AbilitySystemComponent, FGameplayAttribute& InAttribute, FName GroupName, int32 Level) const
 {
-	const FKaosAttributeSetDefaultsCollection* Collection = Defaults.Find(GroupName);
-	if (!Collection)
+	const int32 GroupIndex = FindGroupIndex(GroupName);
+	if (GroupIndex == INDEX_NONE)
 	{
-		ABILITY_LOG(Warning, TEXT("Unable to find DefaultAttributeSet Group %s. Falling back to Defaults"), *GroupName.ToString());
-		Collection = Defaults.Find(FName(TEXT("Default")));
-		if (!Collection)
-		{
-			ABILITY_LOG(Error, TEXT("FAttributeSetInitterDiscreteLevels::InitAttributeSetDefaults Default DefaultAttributeSet not found! Skipping Initialization"));
-			return;
-		}
+		return;
 	}
 
-	if (!Collection->LevelData.IsValidIndex(Level - 1))
+	if (Level < 1 || Level > CompiledDefaults.GetNumLevels(GroupIndex))
 	{
-		// We could eventually extrapolate values outside of the max defined levels
+		// Past the last key with no extrapolation configured, see AttributeDefaultsExtrapolation
 		ABILITY_LOG(Warning, TEXT("Attribute defaults for Level %d are not defined! Skipping"), Level);
 		return;
 	}
 
-	const FKaosAttributeSetDefaults& SetDefaults = Collection->LevelData[Level - 1];
 	for (const UAttributeSet* Set : AbilitySystemComponent->GetSpawnedAttributes())
 	{
 		if (!Set)
@@ -261,65 +377,246 @@ void FKaosAttributeSetInitter::ApplyAttributeDefault(UAbilitySystemComponent* Ab
 			continue;
 		}
 
-		// Iterate to find the parent classes, as this could be a derived set
-		TSubclassOf<UAttributeSet> ParentClass;
-		for (ParentClass = Set->GetClass(); ParentClass ? ParentClass->GetSuperClass() : nullptr; ParentClass = ParentClass->GetSuperClass())
+		const FKaosAttributeDefaultsData::FGroupSetEntry* GroupSet = FindGroupSet(GroupIndex, Set);
+		if (GroupSet)
 		{
-			if (SetDefaults.DataMap.Contains(ParentClass))
+			ABILITY_LOG(Log, TEXT("Initializing Set %s"), *Set->GetName());
+
+			for (const FKaosAttributeDefaultsData::FColumnEntry& Column : CompiledDefaults.GetColumns(*GroupSet))
 			{
-				break;
+				FProperty* Property = CompiledDefaults.GetProperty(Column.PropertyIndex);
+				if (Property && Property == InAttribute.GetUProperty() && Level <= static_cast<int32>(Column.NumLevels))
+				{
+					FGameplayAttribute AttributeToModify(Property);
+					AbilitySystemComponent->SetNumericAttributeBase(AttributeToModify, CompiledDefaults.GetLevelValues(Column)[Level - 1]);
+				}
+			}
+		}
+	}
+
+	AbilitySystemComponent->ForceReplication();
+}
+
+void FKaosAttributeSetInitter::InitAttributeSetDefaultsBatch(TConstArrayView<FKaosAttributeSetInitRequest> Requests, bool bInitialInit) const
+{
+	struct FKaosPendingAttributeChange
+	{
+		UAbilitySystemComponent* AbilitySystemComponent;
+		FGameplayAttribute Attribute;
+		float OldValue;
+		float NewValue;
+	};
+
+	TArray<FKaosPendingAttributeChange> PendingChanges;
+	TArray<UAbilitySystemComponent*> InitializedComponents;
+	InitializedComponents.Reserve(Requests.Num());
+
+	// Spawn waves tend to share a handful of groups, so only look the group up again when it changes
+	FName CachedGroupName = NAME_None;
+	int32 GroupIndex = INDEX_NONE;
+
+	for (const FKaosAttributeSetInitRequest& Request : Requests)
+	{
+		UAbilitySystemComponent* AbilitySystemComponent = Request.AbilitySystemComponent;
+		if (!AbilitySystemComponent)
+		{
+			continue;
+		}
+
+		if (GroupIndex == INDEX_NONE || Request.GroupName != CachedGroupName)
+		{
+			CachedGroupName = Request.GroupName;
+			GroupIndex = FindGroupIndex(Request.GroupName);
+			if (GroupIndex == INDEX_NONE)
+			{
+				continue;
 			}
 		}
 
-		const FKaosAttributeDefaultValueList* DefaultDataList = SetDefaults.DataMap.Find(ParentClass);
-		if (DefaultDataList)
+		if (Request.Level < 1 || Request.Level > CompiledDefaults.GetNumLevels(GroupIndex))
 		{
-			ABILITY_LOG(Log, TEXT("Initializing Set %s"), *Set->GetName());
+			ABILITY_LOG(Warning, TEXT("Attribute defaults for Level %d are not defined! Skipping"), Request.Level);
+			continue;
+		}
 
-			for (auto& DataPair : DefaultDataList->List)
+		UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent);
+		if (KaosAbilitySystemComponent)
+		{
+			KaosAbilitySystemComponent->SetAttributeDefaultsGroup(Request.GroupName, Request.Level);
+		}
+
+		for (const UAttributeSet* Set : AbilitySystemComponent->GetSpawnedAttributes())
+		{
+			if (!Set)
+			{
+				continue;
+			}
+
+			const FKaosAttributeDefaultsData::FGroupSetEntry* GroupSet = FindGroupSet(GroupIndex, Set);
+			if (!GroupSet)
 			{
-				check(DataPair.Property);
+				continue;
+			}
 
-				if (DataPair.Property == InAttribute.GetUProperty())
+			UAttributeSet* MutableSet = const_cast<UAttributeSet*>(Set);
+			for (const FKaosAttributeDefaultsData::FColumnEntry& Column : CompiledDefaults.GetColumns(*GroupSet))
+			{
+				FProperty* Property = CompiledDefaults.GetProperty(Column.PropertyIndex);
+				if (!Property || Request.Level > static_cast<int32>(Column.NumLevels) || !Set->ShouldInitProperty(bInitialInit, Property))
 				{
-					FGameplayAttribute AttributeToModify(DataPair.Property);
-					AbilitySystemComponent->SetNumericAttributeBase(AttributeToModify, DataPair.Value);
+					continue;
 				}
+
+				const float DefaultValue = CompiledDefaults.GetLevelValues(Column)[Request.Level - 1];
+				FGameplayAttribute AttributeToModify(Property);
+				if (!KaosAbilitySystemComponent || KaosAbilitySystemComponent->MayHaveAttributeAggregator(AttributeToModify))
+				{
+					// The aggregator recalculates the current value and broadcasts the change itself, so this one can not be deferred
+					AbilitySystemComponent->SetNumericAttributeBase(AttributeToModify, DefaultValue);
+					continue;
+				}
+
+				// Mirrors FActiveGameplayEffectsContainer::SetAttributeBaseValue without an aggregator, minus the change broadcast
+				const float OldValue = AttributeToModify.GetNumericValue(Set);
+				float NewBaseValue = DefaultValue;
+				Set->PreAttributeBaseChange(AttributeToModify, NewBaseValue);
+
+				float OldBaseValue = OldValue;
+				if (FGameplayAttributeData* DataPtr = AttributeToModify.GetGameplayAttributeData(MutableSet))
+				{
+					OldBaseValue = DataPtr->GetBaseValue();
+					DataPtr->SetBaseValue(NewBaseValue);
+				}
+
+				float NewValue = NewBaseValue;
+				AttributeToModify.SetNumericValueChecked(NewValue, MutableSet);
+				Set->PostAttributeBaseChange(AttributeToModify, OldBaseValue, NewBaseValue);
+
+				PendingChanges.Add({ AbilitySystemComponent, AttributeToModify, OldValue, AttributeToModify.GetNumericValue(Set) });
 			}
 		}
+
+		InitializedComponents.AddUnique(AbilitySystemComponent);
 	}
 
-	AbilitySystemComponent->ForceReplication();
+	for (const FKaosPendingAttributeChange& Change : PendingChanges)
+	{
+		if (Change.OldValue != Change.NewValue)
+		{
+			FOnAttributeChangeData CallbackData;
+			CallbackData.Attribute = Change.Attribute;
+			CallbackData.OldValue = Change.OldValue;
+			CallbackData.NewValue = Change.NewValue;
+			Change.AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Change.Attribute).Broadcast(CallbackData);
+		}
+	}
+
+	for (UAbilitySystemComponent* AbilitySystemComponent : InitializedComponents)
+	{
+		AbilitySystemComponent->ForceReplication();
+	}
 }
 
 TArray<float> FKaosAttributeSetInitter::GetAttributeSetValues(UClass* AttributeSetClass, FProperty* AttributeProperty, FName GroupName) const
 {
-	TArray<float> AttributeSetValues;
-	const FKaosAttributeSetDefaultsCollection* Collection = Defaults.Find(GroupName);
-	if (!Collection)
+	return TArray<float>(GetAttributeSetValuesView(AttributeSetClass, AttributeProperty, GroupName));
+}
+
+TConstArrayView<float> FKaosAttributeSetInitter::GetAttributeSetValuesView(const UClass* AttributeSetClass, const FProperty* AttributeProperty, FName GroupName) const
+{
+	const int32 GroupIndex = FindGroupIndex(GroupName);
+	if (GroupIndex == INDEX_NONE)
+	{
+		return {};
+	}
+
+	const int32 ColumnIndex = CompiledDefaults.FindColumn(GroupIndex, AttributeSetClass, AttributeProperty);
+	return ColumnIndex != INDEX_NONE ? CompiledDefaults.GetLevelValues(CompiledDefaults.GetColumn(ColumnIndex)) : TConstArrayView<float>();
+}
+
+bool FKaosAttributeSetInitter::LoadCookedDefaults(const FString& Filename, uint32 SourceHash)
+{
+	// Cooked defaults replace the curve tables entirely, nothing is left to reload per table
+	Defaults.Reset();
+	TableOrder.Reset();
+	bUsingCookedDefaults = CompiledDefaults.InitializeFromFile(Filename) && CompiledDefaults.GetSourceHash() == SourceHash;
+	if (!bUsingCookedDefaults)
 	{
-		ABILITY_LOG(Error, TEXT("FAttributeSetInitterDiscreteLevels::InitAttributeSetDefaults Default DefaultAttributeSet not found! Skipping Initialization"));
-		return TArray<float>();
+		// Never serve defaults from a stale file
+		CompiledDefaults.InitializeFromMemory({});
 	}
+	return bUsingCookedDefaults;
+}
 
-	for (const FKaosAttributeSetDefaults& SetDefaults : Collection->LevelData)
+bool FKaosAttributeSetInitter::WriteCookedDefaults(const FString& Filename, uint32 SourceHash) const
+{
+	if (Defaults.IsEmpty())
 	{
-		const FKaosAttributeDefaultValueList* DefaultDataList = SetDefaults.DataMap.Find(AttributeSetClass);
-		if (DefaultDataList)
+		ABILITY_LOG(Warning, TEXT("No attribute defaults parsed from curve tables, %s was not written"), *Filename);
+		return false;
+	}
+
+	TArray<uint8> Data;
+	WriteDefaults(Data, SourceHash);
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+void FKaosAttributeSetInitter::CompileDefaults()
+{
+	TArray<uint8> Data;
+	WriteDefaults(Data, 0);
+	CompiledDefaults.InitializeFromMemory(MoveTemp(Data));
+}
+
+void FKaosAttributeSetInitter::WriteDefaults(TArray<uint8>& OutData, uint32 SourceHash) const
+{
+	FKaosAttributeDefaultsWriter Writer;
+	for (const TPair<FName, FKaosAttributeSetDefaultsCollection>& DefaultCollection : Defaults)
+	{
+		Writer.BeginGroup(DefaultCollection.Key);
+		for (const TPair<TSubclassOf<UAttributeSet>, FKaosAttributeSetDefaults>& SetDefaults : DefaultCollection.Value.DataMap)
 		{
-			for (auto& DataPair : DefaultDataList->List)
+			for (const FKaosAttributeDefaultColumn& Column : SetDefaults.Value.Columns)
 			{
-				check(DataPair.Property);
-				if (DataPair.Property == AttributeProperty)
-				{
-					AttributeSetValues.Add(DataPair.Value);
-				}
+				Writer.AddColumn(SetDefaults.Key, Column.Property, Column.GetLevelValues());
 			}
 		}
 	}
-	return AttributeSetValues;
+	Writer.Write(OutData, SourceHash);
+}
+
+int32 FKaosAttributeSetInitter::FindGroupIndex(FName GroupName) const
+{
+	int32 GroupIndex = CompiledDefaults.FindGroup(GroupName);
+	if (GroupIndex == INDEX_NONE)
+	{
+		ABILITY_LOG(Warning, TEXT("Unable to find DefaultAttributeSet Group %s. Falling back to Defaults"), *GroupName.ToString());
+		GroupIndex = CompiledDefaults.FindGroup(FName(TEXT("Default")));
+		if (GroupIndex == INDEX_NONE)
+		{
+			ABILITY_LOG(Error, TEXT("FAttributeSetInitterDiscreteLevels::InitAttributeSetDefaults Default DefaultAttributeSet not found! Skipping Initialization"));
+		}
+	}
+	return GroupIndex;
 }
 
+const FKaosAttributeDefaultsData::FGroupSetEntry* FKaosAttributeSetInitter::FindGroupSet(int32 GroupIndex, const UAttributeSet* Set) const
+{
+	const TConstArrayView<FKaosAttributeDefaultsData::FGroupSetEntry> GroupSets = CompiledDefaults.GetGroupSets(GroupIndex);
+
+	// Iterate to find the parent classes, as this could be a derived set
+	for (const UClass* Class = Set->GetClass(); Class; Class = Class->GetSuperClass())
+	{
+		for (const FKaosAttributeDefaultsData::FGroupSetEntry& GroupSet : GroupSets)
+		{
+			if (CompiledDefaults.GetSetClass(GroupSet.SetIndex) == Class)
+			{
+				return &GroupSet;
+			}
+		}
+	}
+	return nullptr;
+}
 
 bool FKaosAttributeSetInitter::IsSupportedProperty(FProperty* Property) const
 {
@@ -340,6 +340,14 @@ void UKaosGameplayAbility::TryActivatePassiveAbility(const FGameplayAbilityActor
 		UAbilitySystemComponent* ASC = ActorInfo->AbilitySystemComponent.Get();
 		const AActor* AvatarActor = ActorInfo->AvatarActor.Get();
 
+		// Wait for the rest of the batch, passives may depend on effects and attributes granted alongside them.
+		UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(ASC);
+		if (KaosASC && KaosASC->IsGrantingAbilityBatch())
+		{
+			KaosASC->DeferPassiveAbilityActivation(Spec.Handle);
+			return;
+		}
+
 		// If avatar actor is torn off or about to die, don't try to activate until we get the new one.
 		if (ASC && AvatarActor && !AvatarActor->GetTearOff() && (AvatarActor->GetLifeSpan() <= 0.0f))
 		{
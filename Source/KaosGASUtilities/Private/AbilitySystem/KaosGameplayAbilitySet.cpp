@@ -22,17 +22,19 @@
 #include "AbilitySystemComponent.h"
 #include "GameplayEffect.h"
 #include "KaosUtilitiesLogging.h"
-#include "NativeGameplayTags.h"
+#include "Logging/StructuredLog.h"
 #include "Abilities/GameplayAbility.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/DataValidation.h"
+#include <atomic>
 
-namespace ShooterAbilitySetTags
-{
-	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Gameplay_Source_AbilitySet, "Gameplay.Source.AbilitySet");
-}
+#define LOCTEXT_NAMESPACE "KaosGameplayAbilitySet"
 
 namespace AresAbilitySetHandle_Impl
 {
-	static int32 LastHandleId = 0;
+	static std::atomic<int32> LastHandleId = 0;
 	static int32 GetNextQueuedHandleIdForUse() { return ++LastHandleId; }
 }
 
@@ -51,71 +53,509 @@ FKaosAbilitySetHandle UKaosGameplayAbilitySet::GiveAbilitySetTo(UAbilitySystemCo
 		return FKaosAbilitySetHandle();
 	}
 
+	TArray<FSoftObjectPath> PendingSoftReferences;
+	GetPendingSoftReferences(PendingSoftReferences);
+	if (!PendingSoftReferences.IsEmpty())
+	{
+		UE_LOG(LogKaosUtilities, Log, TEXT("Ability set [%s] is synchronously loading %d soft references, use GiveAbilitySetToAsync to stream them instead."), *GetNameSafe(this), PendingSoftReferences.Num());
+	}
+
 	FKaosAbilitySetHandle OutHandle;
 	OutHandle.HandleId = AresAbilitySetHandle_Impl::GetNextQueuedHandleIdForUse();
 	OutHandle.AbilitySystemComponent = ASC;
 
-	// Grant the gameplay abilities.
-	for (int32 AbilityIndex = 0; AbilityIndex < GrantedGameplayAbilities.Num(); ++AbilityIndex)
+	GrantToAbilitySystem(ASC, OverrideSourceObject, OutHandle, TBitArray<>(), TBitArray<>());
+
+	if (UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(ASC))
 	{
-		const FKaosAbilitySet_GameplayAbility& AbilityToGrant = GrantedGameplayAbilities[AbilityIndex];
+		KaosASC->RegisterGrantedAbilitySet(OutHandle);
+	}
+
+	return OutHandle;
+}
 
-		if (!IsValid(AbilityToGrant.Ability))
+void UKaosGameplayAbilitySet::GrantToAbilitySystem(UAbilitySystemComponent* ASC, UObject* OverrideSourceObject, FKaosAbilitySetHandle& InOutHandle, const TBitArray<>& SkippedAbilities, const TBitArray<>& SkippedEffects) const
+{
+	InOutHandle.AbilitySpecHandles.Reserve(InOutHandle.AbilitySpecHandles.Num() + GrantedGameplayAbilities.Num());
+	InOutHandle.GameplayEffectHandles.Reserve(InOutHandle.GameplayEffectHandles.Num() + GrantedGameplayEffects.Num());
+
+	// Grant everything in one batch on Kaos ASCs, specs land together and passives activate once the whole set is in place.
+	TOptional<FKaosScopedAbilityGrantBatch> GrantBatch;
+	if (UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(ASC))
+	{
+		GrantBatch.Emplace(*KaosASC, GrantedGameplayAbilities.Num());
+	}
+
+	const FKaosAbilitySetCompiledGrants& Compiled = GetCompiledGrants();
+
+	// Grant the gameplay abilities.
+	for (int32 AbilityIndex = 0; AbilityIndex < Compiled.AbilitySpecs.Num(); ++AbilityIndex)
+	{
+		if (SkippedAbilities.IsValidIndex(AbilityIndex) && SkippedAbilities[AbilityIndex])
 		{
-			UE_LOG(LogKaosUtilities, Error, TEXT("GrantedGameplayAbilities[%d] on ability set [%s] is not valid."), AbilityIndex, *GetNameSafe(this));
 			continue;
 		}
 
-		UGameplayAbility* AbilityCDO = AbilityToGrant.Ability->GetDefaultObject<UGameplayAbility>();
+		FGameplayAbilitySpec AbilitySpec = Compiled.AbilitySpecs[AbilityIndex];
+		if (!AbilitySpec.Ability)
+		{
+			// Soft references may not have been loaded when compiling, invalid entries were reported by data validation.
+			const TSubclassOf<UGameplayAbility> AbilityClass = GrantedGameplayAbilities[AbilityIndex].LoadAbilityClass();
+			if (!AbilityClass)
+			{
+				continue;
+			}
+			AbilitySpec.Ability = AbilityClass->GetDefaultObject<UGameplayAbility>();
 
-		FGameplayAbilitySpec AbilitySpec(AbilityCDO, AbilityToGrant.AbilityLevel);
+			// Patch the template so later grants skip the load
+			CompiledGrants.AbilitySpecs[AbilityIndex].Ability = AbilitySpec.Ability;
+		}
+		AbilitySpec.Handle.GenerateNewHandle();
 		AbilitySpec.SourceObject = OverrideSourceObject;
-		AbilitySpec.GetDynamicSpecSourceTags().AddTag(AbilityToGrant.InputTag);
 
 		const FGameplayAbilitySpecHandle AbilitySpecHandle = ASC->GiveAbility(AbilitySpec);
-		OutHandle.AddAbilitySpecHandle(AbilitySpecHandle);
+		InOutHandle.AddAbilitySpecHandle(AbilitySpecHandle);
 	}
 
 	// Grant the gameplay effects.
-	for (int32 EffectIndex = 0; EffectIndex < GrantedGameplayEffects.Num(); ++EffectIndex)
+	for (int32 EffectIndex = 0; EffectIndex < Compiled.GameplayEffects.Num(); ++EffectIndex)
 	{
-		const FKaosAbilitySet_GameplayEffect& EffectToGrant = GrantedGameplayEffects[EffectIndex];
-
-		if (!IsValid(EffectToGrant.GameplayEffect))
+		if (SkippedEffects.IsValidIndex(EffectIndex) && SkippedEffects[EffectIndex])
 		{
-			UE_LOG(LogKaosUtilities, Error, TEXT("GrantedGameplayEffects[%d] on ability set [%s] is not valid"), EffectIndex, *GetNameSafe(this));
 			continue;
 		}
 
-		const UGameplayEffect* GameplayEffect = EffectToGrant.GameplayEffect->GetDefaultObject<UGameplayEffect>();
-		const FActiveGameplayEffectHandle GameplayEffectHandle = ASC->ApplyGameplayEffectToSelf(GameplayEffect, EffectToGrant.EffectLevel, ASC->MakeEffectContext());
-		OutHandle.AddGameplayEffectHandle(GameplayEffectHandle);
+		const FKaosAbilitySetCompiledEffect& EffectToGrant = Compiled.GameplayEffects[EffectIndex];
+		const UGameplayEffect* GameplayEffect = EffectToGrant.GameplayEffect;
+		if (!GameplayEffect)
+		{
+			const TSubclassOf<UGameplayEffect> EffectClass = GrantedGameplayEffects[EffectIndex].LoadGameplayEffectClass();
+			if (!EffectClass)
+			{
+				continue;
+			}
+			CompiledGrants.GameplayEffects[EffectIndex].GameplayEffect = EffectClass->GetDefaultObject<UGameplayEffect>();
+			GameplayEffect = CompiledGrants.GameplayEffects[EffectIndex].GameplayEffect;
+		}
+
+		// Each effect gets its own context, effects that write to theirs must not leak into the others of the batch
+		const FGameplayEffectContextHandle EffectContext = ASC->MakeEffectContext();
+		const FActiveGameplayEffectHandle GameplayEffectHandle = ASC->ApplyGameplayEffectToSelf(GameplayEffect, EffectToGrant.EffectLevel, EffectContext);
+		InOutHandle.AddGameplayEffectHandle(GameplayEffectHandle);
 	}
 
 	// Grant the attribute sets.
-	for (int32 SetIndex = 0; SetIndex < GrantedAttributeSets.Num(); ++SetIndex)
+	UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(ASC);
+	for (int32 SetIndex = 0; SetIndex < Compiled.AttributeSets.Num(); ++SetIndex)
 	{
-		const FKaosAbilitySet_AttributeSet& Set = GrantedAttributeSets[SetIndex];
-
-		if (!IsValid(Set.AttributeSet))
+		TSubclassOf<UAttributeSet> AttributeSetClass = Compiled.AttributeSets[SetIndex];
+		if (!AttributeSetClass)
 		{
-			UE_LOG(LogKaosUtilities, Error, TEXT("GrantedAttributes[%d] on ability set [%s] is not valid"), SetIndex, *GetNameSafe(this));
-			continue;
+			AttributeSetClass = GrantedAttributeSets[SetIndex].LoadAttributeSetClass();
+			if (!AttributeSetClass)
+			{
+				continue;
+			}
+			CompiledGrants.AttributeSets[SetIndex] = AttributeSetClass;
 		}
 
 		//They already have the attribute set. Don't give it again.
 		// AddSpawnedAttribute WILL handle this, but we have constructed an object that will just get GC'd
 		// kind of pointless if we can just catch this now.
-		if (ASC->GetAttributeSet(Set.AttributeSet))
+		if (ASC->GetAttributeSet(AttributeSetClass))
 		{
 			continue;
 		}
 		
-		UAttributeSet* NewSet = NewObject<UAttributeSet>(ASC->GetOwner(), Set.AttributeSet);
-		ASC->AddSpawnedAttribute(NewSet);
+		if (!GrantedAttributeSets[SetIndex].bReleaseWithAbilitySet)
+		{
+			UAttributeSet* NewSet = NewObject<UAttributeSet>(ASC->GetOwner(), AttributeSetClass);
+			ASC->AddSpawnedAttribute(NewSet);
+		}
+		else if (KaosASC)
+		{
+			InOutHandle.AddAttributeSet(KaosASC->AcquireAttributeSet(AttributeSetClass));
+		}
+		else
+		{
+			UAttributeSet* NewSet = NewObject<UAttributeSet>(ASC->GetOwner(), AttributeSetClass);
+			ASC->AddSpawnedAttribute(NewSet);
+			InOutHandle.AddAttributeSet(NewSet);
+		}
 	}
+}
 
-	return OutHandle;
+const FKaosAbilitySetCompiledGrants& UKaosGameplayAbilitySet::GetCompiledGrants() const
+{
+	if (CompiledGrants.bCompiled)
+	{
+		return CompiledGrants;
+	}
+
+	CompiledGrants.AbilitySpecs.Reset(GrantedGameplayAbilities.Num());
+	for (const FKaosAbilitySet_GameplayAbility& Ability : GrantedGameplayAbilities)
+	{
+		FGameplayAbilitySpec& AbilitySpec = CompiledGrants.AbilitySpecs.AddDefaulted_GetRef();
+		if (const TSubclassOf<UGameplayAbility> AbilityClass = Ability.GetAbilityClass())
+		{
+			AbilitySpec.Ability = AbilityClass->GetDefaultObject<UGameplayAbility>();
+		}
+		AbilitySpec.Level = Ability.AbilityLevel;
+		AbilitySpec.GetDynamicSpecSourceTags().AddTag(Ability.InputTag);
+	}
+
+	CompiledGrants.GameplayEffects.Reset(GrantedGameplayEffects.Num());
+	for (const FKaosAbilitySet_GameplayEffect& Effect : GrantedGameplayEffects)
+	{
+		FKaosAbilitySetCompiledEffect& CompiledEffect = CompiledGrants.GameplayEffects.AddDefaulted_GetRef();
+		if (const TSubclassOf<UGameplayEffect> EffectClass = Effect.GetGameplayEffectClass())
+		{
+			CompiledEffect.GameplayEffect = EffectClass->GetDefaultObject<UGameplayEffect>();
+		}
+		CompiledEffect.EffectLevel = Effect.EffectLevel;
+	}
+
+	CompiledGrants.AttributeSets.Reset(GrantedAttributeSets.Num());
+	for (const FKaosAbilitySet_AttributeSet& Set : GrantedAttributeSets)
+	{
+		CompiledGrants.AttributeSets.Add(Set.GetAttributeSetClass());
+	}
+
+	CompiledGrants.bCompiled = true;
+	return CompiledGrants;
+}
+
+void UKaosGameplayAbilitySet::ResolveLoadedCompiledGrants() const
+{
+	if (!CompiledGrants.bCompiled)
+	{
+		// Compiling picks up everything loaded by now
+		return;
+	}
+
+	for (int32 AbilityIndex = 0; AbilityIndex < CompiledGrants.AbilitySpecs.Num(); ++AbilityIndex)
+	{
+		FGameplayAbilitySpec& AbilitySpec = CompiledGrants.AbilitySpecs[AbilityIndex];
+		if (!AbilitySpec.Ability)
+		{
+			if (const TSubclassOf<UGameplayAbility> AbilityClass = GrantedGameplayAbilities[AbilityIndex].GetAbilityClass())
+			{
+				AbilitySpec.Ability = AbilityClass->GetDefaultObject<UGameplayAbility>();
+			}
+		}
+	}
+
+	for (int32 EffectIndex = 0; EffectIndex < CompiledGrants.GameplayEffects.Num(); ++EffectIndex)
+	{
+		FKaosAbilitySetCompiledEffect& CompiledEffect = CompiledGrants.GameplayEffects[EffectIndex];
+		if (!CompiledEffect.GameplayEffect)
+		{
+			if (const TSubclassOf<UGameplayEffect> EffectClass = GrantedGameplayEffects[EffectIndex].GetGameplayEffectClass())
+			{
+				CompiledEffect.GameplayEffect = EffectClass->GetDefaultObject<UGameplayEffect>();
+			}
+		}
+	}
+
+	for (int32 SetIndex = 0; SetIndex < CompiledGrants.AttributeSets.Num(); ++SetIndex)
+	{
+		if (!CompiledGrants.AttributeSets[SetIndex])
+		{
+			CompiledGrants.AttributeSets[SetIndex] = GrantedAttributeSets[SetIndex].GetAttributeSetClass();
+		}
+	}
+}
+
+#if WITH_EDITOR
+EDataValidationResult UKaosGameplayAbilitySet::IsDataValid(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = CombineDataValidationResults(Super::IsDataValid(Context), EDataValidationResult::Valid);
+
+	for (int32 AbilityIndex = 0; AbilityIndex < GrantedGameplayAbilities.Num(); ++AbilityIndex)
+	{
+		const FKaosAbilitySet_GameplayAbility& Ability = GrantedGameplayAbilities[AbilityIndex];
+		if (!Ability.Ability && Ability.SoftAbility.IsNull())
+		{
+			Context.AddError(FText::Format(LOCTEXT("InvalidAbility", "GrantedGameplayAbilities[{0}] has no ability class."), AbilityIndex));
+			Result = EDataValidationResult::Invalid;
+		}
+		else if (Ability.Ability && !Ability.SoftAbility.IsNull())
+		{
+			Context.AddWarning(FText::Format(LOCTEXT("AbilityHardAndSoft", "GrantedGameplayAbilities[{0}] has both Ability and SoftAbility set, SoftAbility is ignored."), AbilityIndex));
+		}
+
+		if (Ability.AbilityLevel < 1)
+		{
+			Context.AddError(FText::Format(LOCTEXT("InvalidAbilityLevel", "GrantedGameplayAbilities[{0}] has an ability level below 1."), AbilityIndex));
+			Result = EDataValidationResult::Invalid;
+		}
+	}
+
+	for (int32 EffectIndex = 0; EffectIndex < GrantedGameplayEffects.Num(); ++EffectIndex)
+	{
+		const FKaosAbilitySet_GameplayEffect& Effect = GrantedGameplayEffects[EffectIndex];
+		if (!Effect.GameplayEffect && Effect.SoftGameplayEffect.IsNull())
+		{
+			Context.AddError(FText::Format(LOCTEXT("InvalidEffect", "GrantedGameplayEffects[{0}] has no gameplay effect class."), EffectIndex));
+			Result = EDataValidationResult::Invalid;
+		}
+		else if (Effect.GameplayEffect && !Effect.SoftGameplayEffect.IsNull())
+		{
+			Context.AddWarning(FText::Format(LOCTEXT("EffectHardAndSoft", "GrantedGameplayEffects[{0}] has both GameplayEffect and SoftGameplayEffect set, SoftGameplayEffect is ignored."), EffectIndex));
+		}
+	}
+
+	TSet<FSoftObjectPath> SeenAttributeSets;
+	for (int32 SetIndex = 0; SetIndex < GrantedAttributeSets.Num(); ++SetIndex)
+	{
+		const FKaosAbilitySet_AttributeSet& Set = GrantedAttributeSets[SetIndex];
+		const FSoftObjectPath SetPath = Set.GetAttributeSetClassPath();
+		if (SetPath.IsNull())
+		{
+			Context.AddError(FText::Format(LOCTEXT("InvalidAttributeSet", "GrantedAttributeSets[{0}] has no attribute set class."), SetIndex));
+			Result = EDataValidationResult::Invalid;
+		}
+		else if (SeenAttributeSets.Contains(SetPath))
+		{
+			Context.AddWarning(FText::Format(LOCTEXT("DuplicateAttributeSet", "GrantedAttributeSets[{0}] grants an attribute set that is already granted by this set."), SetIndex));
+		}
+		SeenAttributeSets.Add(SetPath);
+	}
+
+	return Result;
+}
+
+void UKaosGameplayAbilitySet::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	CompiledGrants = FKaosAbilitySetCompiledGrants();
+}
+#endif
+
+FKaosAbilitySetHandle UKaosGameplayAbilitySet::SwapAbilitySet(FKaosAbilitySetHandle& OldHandle, const UKaosGameplayAbilitySet* NewSet, UObject* OverrideSourceObject)
+{
+	check(NewSet);
+
+	UAbilitySystemComponent* ASC = OldHandle.AbilitySystemComponent.Get();
+	if (!OldHandle.IsValid() || !ASC->IsOwnerActorAuthoritative())
+	{
+		// Must be authoritative to give or take ability sets.
+		return FKaosAbilitySetHandle();
+	}
+
+	// The Kaos ASC holds the authoritative record, the handle passed in may be a stale copy of a set that was already removed.
+	FKaosAbilitySetHandle OldGranted = OldHandle;
+	UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(ASC);
+	if (KaosASC && !KaosASC->UnregisterGrantedAbilitySet(OldHandle.HandleId, OldGranted))
+	{
+		OldGranted.Reset();
+	}
+
+	FKaosAbilitySetHandle NewHandle;
+	NewHandle.HandleId = AresAbilitySetHandle_Impl::GetNextQueuedHandleIdForUse();
+	NewHandle.AbilitySystemComponent = ASC;
+
+	// Carry over abilities granted identically by both sets, their spec handles and instances stay untouched.
+	TBitArray<> CarriedAbilities(false, NewSet->GrantedGameplayAbilities.Num());
+	for (const FGameplayAbilitySpecHandle& SpecHandle : OldGranted.AbilitySpecHandles)
+	{
+		const FGameplayAbilitySpec* Spec = ASC->FindAbilitySpecFromHandle(SpecHandle);
+		const int32 MatchIndex = Spec ? NewSet->FindMatchingAbility(*Spec, OverrideSourceObject, CarriedAbilities) : INDEX_NONE;
+		if (MatchIndex != INDEX_NONE)
+		{
+			CarriedAbilities[MatchIndex] = true;
+			NewHandle.AddAbilitySpecHandle(SpecHandle);
+		}
+		else if (SpecHandle.IsValid())
+		{
+			ASC->ClearAbility(SpecHandle);
+		}
+	}
+
+	TBitArray<> CarriedEffects(false, NewSet->GrantedGameplayEffects.Num());
+	for (const FActiveGameplayEffectHandle& EffectHandle : OldGranted.GameplayEffectHandles)
+	{
+		const FActiveGameplayEffect* ActiveEffect = ASC->GetActiveGameplayEffect(EffectHandle);
+		const int32 MatchIndex = ActiveEffect ? NewSet->FindMatchingEffect(*ActiveEffect, CarriedEffects) : INDEX_NONE;
+		if (MatchIndex != INDEX_NONE)
+		{
+			CarriedEffects[MatchIndex] = true;
+			NewHandle.AddGameplayEffectHandle(EffectHandle);
+		}
+		else if (EffectHandle.IsValid())
+		{
+			ASC->RemoveActiveGameplayEffect(EffectHandle);
+		}
+	}
+
+	// Attribute sets released with the old set stay if the new set releases the same class too, GrantToAbilitySystem skips sets the ASC already has.
+	for (const TWeakObjectPtr<UAttributeSet>& WeakAttributeSet : OldGranted.AttributeSets)
+	{
+		UAttributeSet* AttributeSet = WeakAttributeSet.Get();
+		if (!AttributeSet)
+		{
+			continue;
+		}
+
+		const FSoftObjectPath AttributeSetClassPath(AttributeSet->GetClass());
+		const bool bCarried = NewSet->GrantedAttributeSets.ContainsByPredicate([&AttributeSetClassPath](const FKaosAbilitySet_AttributeSet& Set)
+		{
+			return Set.bReleaseWithAbilitySet && Set.GetAttributeSetClassPath() == AttributeSetClassPath;
+		});
+
+		if (bCarried)
+		{
+			NewHandle.AddAttributeSet(AttributeSet);
+		}
+		else
+		{
+			FKaosAbilitySetHandle::ReleaseAttributeSet(*ASC, AttributeSet);
+		}
+	}
+
+	NewSet->GrantToAbilitySystem(ASC, OverrideSourceObject, NewHandle, CarriedAbilities, CarriedEffects);
+
+	if (KaosASC)
+	{
+		KaosASC->RegisterGrantedAbilitySet(NewHandle);
+	}
+
+	UE_LOGFMT(LogKaosUtilities, Log, "Swapped ability set with handle {OldHandle} for {NewSet} with handle {NewHandle}, carried over {Abilities} abilities and {Effects} effects",
+		OldHandle.HandleId, GetNameSafe(NewSet), NewHandle.HandleId, CarriedAbilities.CountSetBits(), CarriedEffects.CountSetBits());
+
+	OldHandle.Reset();
+	return NewHandle;
+}
+
+int32 UKaosGameplayAbilitySet::FindMatchingAbility(const FGameplayAbilitySpec& Spec, const UObject* SourceObject, const TBitArray<>& ClaimedAbilities) const
+{
+	if (!Spec.Ability || Spec.SourceObject.Get() != SourceObject)
+	{
+		return INDEX_NONE;
+	}
+
+	// Compared by path, entries with a soft reference that is not loaded yet have no class to compare against
+	const FSoftObjectPath SpecAbilityClassPath(Spec.Ability->GetClass());
+
+	// Granted specs carry exactly their input tag as dynamic tags, a carried spec keeps them so they have to be identical, including neither having one
+	const FGameplayTagContainer& SpecInputTags = Spec.GetDynamicSpecSourceTags();
+	for (int32 AbilityIndex = 0; AbilityIndex < GrantedGameplayAbilities.Num(); ++AbilityIndex)
+	{
+		const FKaosAbilitySet_GameplayAbility& Ability = GrantedGameplayAbilities[AbilityIndex];
+		const bool bSameInputTag = Ability.InputTag.IsValid() ? SpecInputTags.Num() == 1 && SpecInputTags.HasTagExact(Ability.InputTag) : SpecInputTags.IsEmpty();
+		if (!ClaimedAbilities[AbilityIndex]
+			&& Spec.Level == Ability.AbilityLevel
+			&& bSameInputTag
+			&& Ability.GetAbilityClassPath() == SpecAbilityClassPath)
+		{
+			return AbilityIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 UKaosGameplayAbilitySet::FindMatchingEffect(const FActiveGameplayEffect& ActiveEffect, const TBitArray<>& ClaimedEffects) const
+{
+	if (ActiveEffect.IsPendingRemove || !ActiveEffect.Spec.Def)
+	{
+		return INDEX_NONE;
+	}
+
+	const FSoftObjectPath EffectClassPath(ActiveEffect.Spec.Def->GetClass());
+	for (int32 EffectIndex = 0; EffectIndex < GrantedGameplayEffects.Num(); ++EffectIndex)
+	{
+		const FKaosAbilitySet_GameplayEffect& Effect = GrantedGameplayEffects[EffectIndex];
+		if (!ClaimedEffects[EffectIndex]
+			&& FMath::IsNearlyEqual(ActiveEffect.Spec.GetLevel(), Effect.EffectLevel)
+			&& Effect.GetGameplayEffectClassPath() == EffectClassPath)
+		{
+			return EffectIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+TSharedPtr<FStreamableHandle> UKaosGameplayAbilitySet::GiveAbilitySetToAsync(UAbilitySystemComponent* ASC, FKaosOnAbilitySetGrantedAsync OnGranted, UObject* OverrideSourceObject) const
+{
+	check(ASC);
+
+	if (!ASC->IsOwnerActorAuthoritative())
+	{
+		// Must be authoritative to give or take ability sets.
+		OnGranted.ExecuteIfBound(FKaosAbilitySetHandle(), 0.0);
+		return nullptr;
+	}
+
+	TArray<FSoftObjectPath> PendingSoftReferences;
+	GetPendingSoftReferences(PendingSoftReferences);
+	if (PendingSoftReferences.IsEmpty())
+	{
+		OnGranted.ExecuteIfBound(GiveAbilitySetTo(ASC, OverrideSourceObject), 0.0);
+		return nullptr;
+	}
+
+	const double RequestTime = FPlatformTime::Seconds();
+	TWeakObjectPtr<const UKaosGameplayAbilitySet> WeakSet(this);
+	TWeakObjectPtr<UAbilitySystemComponent> WeakASC(ASC);
+	TWeakObjectPtr<UObject> WeakSourceObject(OverrideSourceObject);
+
+	TSharedPtr<FStreamableHandle> StreamableHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(PendingSoftReferences), FStreamableDelegate::CreateLambda([WeakSet, WeakASC, WeakSourceObject, OnGranted, RequestTime]()
+	{
+		const double LoadSeconds = FPlatformTime::Seconds() - RequestTime;
+
+		const UKaosGameplayAbilitySet* AbilitySet = WeakSet.Get();
+		if (AbilitySet)
+		{
+			// The compiled grants now reference the loaded classes and keep them alive, the handle is no longer needed
+			AbilitySet->ResolveLoadedCompiledGrants();
+			AbilitySet->PendingLoadHandles.RemoveAll([](const TSharedPtr<FStreamableHandle>& Handle) { return !Handle.IsValid() || Handle->HasLoadCompleted() || Handle->WasCanceled(); });
+		}
+
+		UAbilitySystemComponent* AbilitySystemComponent = WeakASC.Get();
+		if (!AbilitySet || !AbilitySystemComponent)
+		{
+			UE_LOG(LogKaosUtilities, Warning, TEXT("Ability set or ability system component went away while streaming the set, nothing was granted."));
+			OnGranted.ExecuteIfBound(FKaosAbilitySetHandle(), LoadSeconds);
+			return;
+		}
+
+		UE_LOG(LogKaosUtilities, Verbose, TEXT("Streamed ability set [%s] for [%s] in %.2fms"), *AbilitySet->GetName(), *GetNameSafe(AbilitySystemComponent->GetOwner()), LoadSeconds * 1000.0);
+		OnGranted.ExecuteIfBound(AbilitySet->GiveAbilitySetTo(AbilitySystemComponent, WeakSourceObject.Get()), LoadSeconds);
+	}));
+
+	// Keep the load going even if the caller drops the handle
+	if (StreamableHandle.IsValid() && !StreamableHandle->HasLoadCompleted())
+	{
+		PendingLoadHandles.Add(StreamableHandle);
+	}
+	return StreamableHandle;
+}
+
+void UKaosGameplayAbilitySet::GetPendingSoftReferences(TArray<FSoftObjectPath>& OutSoftReferences) const
+{
+	for (const FKaosAbilitySet_GameplayAbility& Ability : GrantedGameplayAbilities)
+	{
+		if (!Ability.Ability && Ability.SoftAbility.IsPending())
+		{
+			OutSoftReferences.AddUnique(Ability.SoftAbility.ToSoftObjectPath());
+		}
+	}
+
+	for (const FKaosAbilitySet_GameplayEffect& Effect : GrantedGameplayEffects)
+	{
+		if (!Effect.GameplayEffect && Effect.SoftGameplayEffect.IsPending())
+		{
+			OutSoftReferences.AddUnique(Effect.SoftGameplayEffect.ToSoftObjectPath());
+		}
+	}
+
+	for (const FKaosAbilitySet_AttributeSet& Set : GrantedAttributeSets)
+	{
+		if (!Set.AttributeSet && Set.SoftAttributeSet.IsPending())
+		{
+			OutSoftReferences.AddUnique(Set.SoftAttributeSet.ToSoftObjectPath());
+		}
+	}
 }
 
 FKaosAbilitySetHandle UKaosGameplayAbilitySet::GiveAbilitySetToInterface(TScriptInterface<IAbilitySystemInterface> AbilitySystemInterface, UObject* OverrideSourceObject) const
@@ -136,15 +576,15 @@ void UKaosGameplayAbilitySet::RemoveAllAbilitySets(UAbilitySystemComponent* ASC)
 	{
 		return;
 	}
-	
-	for (const FGameplayAbilitySpec& Spec : ASC->GetActivatableAbilities())
+
+	UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(ASC);
+	if (!KaosASC)
 	{
-		if (Spec.GetDynamicSpecSourceTags().HasTag(ShooterAbilitySetTags::TAG_Gameplay_Source_AbilitySet))
-		{
-			ASC->ClearAbility(Spec.Handle);
-		}
+		UE_LOG(LogKaosUtilities, Warning, TEXT("Cannot remove all ability sets from [%s], granted sets are only tracked by UKaosAbilitySystemComponent. Remove them by handle instead."), *GetNameSafe(ASC));
+		return;
 	}
-	
-	FGameplayEffectQuery Query = FGameplayEffectQuery::MakeQuery_MatchAnyEffectTags(FGameplayTagContainer(ShooterAbilitySetTags::TAG_Gameplay_Source_AbilitySet));
-	ASC->RemoveActiveEffects(Query);
+
+	KaosASC->RemoveAllGrantedAbilitySets();
 }
+
+#undef LOCTEXT_NAMESPACE
@@ -22,40 +22,217 @@
 #include "AbilitySystemComponent.h"
 #include "AbilitySystemGlobals.h"
 #include "AbilitySystemLog.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
+#include "AbilitySystem/KaosAbilitySystemGlobals.h"
+#include "KaosGASUtilities.h"
 #include "KaosUtilitiesLogging.h"
 #include "GameplayEffect.h"
 #include "Logging/StructuredLog.h"
 
 
 FKaosGameplayAttributeChangedEventWrapperSpec::FKaosGameplayAttributeChangedEventWrapperSpec(UAbilitySystemComponent* AbilitySystemComponent,
-	FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate)
+	FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate, EKaosAttributeChangedDelivery InDelivery, float DeliveryRateHz)
 	: AbilitySystemComponentWk(AbilitySystemComponent)
 	, GameplayAttributeChangedEventWrapperDelegate(InGameplayAttributeChangedEventWrapperDelegate)
+	, Delivery(InDelivery)
+	, DeliveryInterval(InDelivery == EKaosAttributeChangedDelivery::FixedRate && DeliveryRateHz > 0.f ? 1.f / DeliveryRateHz : 0.f)
 {
 }
 
 FKaosGameplayAttributeChangedEventWrapperSpec::~FKaosGameplayAttributeChangedEventWrapperSpec()
 {
-	const int32 RemainingDelegateBindingsCount = DelegateBindings.Num();
-	if (RemainingDelegateBindingsCount > 0)
+	// Bound specs are owned by the ASC delegates, so any binding left here died with the ASC
+	CancelPendingDelivery();
+}
+
+TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> FKaosGameplayAttributeChangedEventWrapperSpec::Create(UAbilitySystemComponent* AbilitySystemComponent,
+	FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate, EKaosAttributeChangedDelivery InDelivery, float DeliveryRateHz)
+{
+	FKaosGameplayAttributeChangedEventWrapperSpecPool* Pool = FKaosGASUtilitiesModule::GetEventWrapperSpecPool();
+	if (Pool && IsInGameThread())
+	{
+		return Pool->Acquire(AbilitySystemComponent, InGameplayAttributeChangedEventWrapperDelegate, InDelivery, DeliveryRateHz);
+	}
+	return MakeShared<FKaosGameplayAttributeChangedEventWrapperSpec>(AbilitySystemComponent, InGameplayAttributeChangedEventWrapperDelegate, InDelivery, DeliveryRateHz);
+}
+
+void FKaosGameplayAttributeChangedEventWrapperSpec::Reinitialize(UAbilitySystemComponent* AbilitySystemComponent,
+	FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate, EKaosAttributeChangedDelivery InDelivery, float DeliveryRateHz)
+{
+	// Bindings left here died with their ASC, live ones would still reference the spec
+	CancelPendingDelivery();
+	DelegateBindings.Reset();
+
+	AbilitySystemComponentWk = AbilitySystemComponent;
+	GameplayAttributeChangedEventWrapperDelegate = InGameplayAttributeChangedEventWrapperDelegate;
+	Delivery = InDelivery;
+	DeliveryInterval = InDelivery == EKaosAttributeChangedDelivery::FixedRate && DeliveryRateHz > 0.f ? 1.f / DeliveryRateHz : 0.f;
+}
+
+TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> FKaosGameplayAttributeChangedEventWrapperSpecPool::Acquire(UAbilitySystemComponent* AbilitySystemComponent,
+	FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate, EKaosAttributeChangedDelivery InDelivery, float DeliveryRateHz)
+{
+	check(IsInGameThread());
+
+	for (const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec>& Spec : Specs)
+	{
+		if (Spec.GetSharedReferenceCount() == 1)
+		{
+			Spec->Reinitialize(AbilitySystemComponent, InGameplayAttributeChangedEventWrapperDelegate, InDelivery, DeliveryRateHz);
+			return Spec;
+		}
+	}
+
+	// MakeShared allocates the spec and its reference controller together
+	TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> Spec = MakeShared<FKaosGameplayAttributeChangedEventWrapperSpec>(
+		AbilitySystemComponent, InGameplayAttributeChangedEventWrapperDelegate, InDelivery, DeliveryRateHz);
+	if (Specs.Num() < MaxPooledSpecs)
+	{
+		Specs.Add(Spec);
+	}
+	return Spec;
+}
+
+void FKaosGameplayAttributeChangedEventWrapperSpec::Bind(const FGameplayAttribute& Attribute)
+{
+	UAbilitySystemComponent* AbilitySystemComponent = AbilitySystemComponentWk.Get();
+	if (AbilitySystemComponent == nullptr)
 	{
-		// We still have delegates bound to the ASC - we need to warn the user!
-		// We expect the user to unbind delegates they bound.
+		return;
+	}
+
+	// Bind to the ASC's attribute change listening delegate (which is not a 'dynamic' delegate and thereby can't be used in BP).
+	// The binding keeps the spec alive until it is unbound or the ASC goes away, Blueprints are free to ignore the returned handle.
+	const FDelegateHandle AttributeChangedDelegateHandle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).AddLambda(
+		[Spec = AsShared()](const FOnAttributeChangeData& ChangeData)
+		{
+			Spec->HandleAttributeChanged(ChangeData);
+		});
+	DelegateBindings.Add({ Attribute, AttributeChangedDelegateHandle });
 
-		// The exception is if the ASC itself is not valid which indicates things are tearing down - in that case, we'll give them a pass since it's a moot point that
-		//  we are still bound if the ASC isn't around anymore.
-		UAbilitySystemComponent* AbilitySystemComponent = AbilitySystemComponentWk.Get();
-		if (IsValid(AbilitySystemComponent))
+	if (DelegateBindings.Num() == 1)
+	{
+		if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent))
 		{
-			ABILITY_LOG(
-				Error, 
-				TEXT("~FKaosGameplayAttributeChangedEventWrapperSpec: our bound spec is being destroyed but we still have %d delegate bindings bound to the ASC on '%s'! Please cache off the Bound delegate handle and unbind it when finished."),
-				RemainingDelegateBindingsCount,
-				*GetNameSafe(AbilitySystemComponent->GetOwner()));
+			KaosAbilitySystemComponent->RegisterAttributeChangedEventWrapper(AsShared());
 		}
 	}
 }
 
+bool FKaosGameplayAttributeChangedEventWrapperSpec::Unbind(const FGameplayAttribute& Attribute)
+{
+	const int32 BindingIndex = DelegateBindings.IndexOfByPredicate([&Attribute](const FKaosAttributeChangedBinding& Binding) { return Binding.Attribute == Attribute; });
+	if (BindingIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Removing the binding may release the last reference to this spec
+	const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> KeepAlive = AsShared();
+	UAbilitySystemComponent* AbilitySystemComponent = AbilitySystemComponentWk.Get();
+	if (AbilitySystemComponent != nullptr)
+	{
+		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).Remove(DelegateBindings[BindingIndex].DelegateHandle);
+	}
+	DelegateBindings.RemoveAtSwap(BindingIndex, EAllowShrinking::No);
+	PendingChanges.RemoveAllSwap([&Attribute](const FKaosPendingAttributeChange& Pending) { return Pending.Attribute == Attribute; }, EAllowShrinking::No);
+
+	if (DelegateBindings.IsEmpty())
+	{
+		if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent))
+		{
+			KaosAbilitySystemComponent->UnregisterAttributeChangedEventWrapper(this);
+		}
+	}
+	return true;
+}
+
+void FKaosGameplayAttributeChangedEventWrapperSpec::UnbindAll()
+{
+	// Removing the bindings may release the last reference to this spec
+	const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> KeepAlive = AsShared();
+	CancelPendingDelivery();
+
+	// The delegates die with the ASC, so there is nothing to remove if it is already gone
+	UAbilitySystemComponent* AbilitySystemComponent = AbilitySystemComponentWk.Get();
+	if (AbilitySystemComponent != nullptr)
+	{
+		for (const FKaosAttributeChangedBinding& Binding : DelegateBindings)
+		{
+			AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Binding.Attribute).Remove(Binding.DelegateHandle);
+		}
+
+		if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent))
+		{
+			KaosAbilitySystemComponent->UnregisterAttributeChangedEventWrapper(this);
+		}
+	}
+	DelegateBindings.Reset();
+}
+
+void FKaosGameplayAttributeChangedEventWrapperSpec::HandleAttributeChanged(const FOnAttributeChangeData& ChangeData)
+{
+	// The widget or other object the wrapper was bound for is gone, its bindings go with it
+	if (!GameplayAttributeChangedEventWrapperDelegate.IsBound())
+	{
+		UnbindAll();
+		return;
+	}
+
+	if (Delivery == EKaosAttributeChangedDelivery::Immediate)
+	{
+		GameplayAttributeChangedEventWrapperDelegate.ExecuteIfBound(ChangeData.Attribute, ChangeData.OldValue, ChangeData.NewValue);
+		return;
+	}
+
+	if (FKaosPendingAttributeChange* PendingChange = PendingChanges.FindByPredicate([&ChangeData](const FKaosPendingAttributeChange& Pending) { return Pending.Attribute == ChangeData.Attribute; }))
+	{
+		PendingChange->NewValue = ChangeData.NewValue;
+	}
+	else
+	{
+		PendingChanges.Add({ ChangeData.Attribute, ChangeData.OldValue, ChangeData.NewValue });
+	}
+
+	if (!DeliveryTickerHandle.IsValid())
+	{
+		DeliveryTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FKaosGameplayAttributeChangedEventWrapperSpec::DeliverPendingChanges), DeliveryInterval);
+	}
+}
+
+void FKaosGameplayAttributeChangedEventWrapperSpec::CancelPendingDelivery()
+{
+	if (DeliveryTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(DeliveryTickerHandle);
+		DeliveryTickerHandle.Reset();
+	}
+	PendingChanges.Reset();
+}
+
+bool FKaosGameplayAttributeChangedEventWrapperSpec::DeliverPendingChanges(float DeltaTime)
+{
+	// The ticker is re-added by the next change, so an idle binding costs nothing
+	DeliveryTickerHandle.Reset();
+
+	if (!GameplayAttributeChangedEventWrapperDelegate.IsBound())
+	{
+		UnbindAll();
+		return false;
+	}
+
+	// The wrapper may bind or unbind from inside the event
+	const TArray<FKaosPendingAttributeChange, TInlineAllocator<4>> ChangesToDeliver = MoveTemp(PendingChanges);
+	PendingChanges.Reset();
+	for (const FKaosPendingAttributeChange& Change : ChangesToDeliver)
+	{
+		if (Change.OldValue != Change.NewValue)
+		{
+			GameplayAttributeChangedEventWrapperDelegate.ExecuteIfBound(Change.Attribute, Change.OldValue, Change.NewValue);
+		}
+	}
+	return false;
+}
 
 FKaosGameplayAttributeChangedEventWrapperSpecHandle::FKaosGameplayAttributeChangedEventWrapperSpecHandle()
 	: Data(nullptr)
@@ -67,6 +244,11 @@ FKaosGameplayAttributeChangedEventWrapperSpecHandle::FKaosGameplayAttributeChang
 {
 }
 
+FKaosGameplayAttributeChangedEventWrapperSpecHandle::FKaosGameplayAttributeChangedEventWrapperSpecHandle(TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec> InData)
+	: Data(MoveTemp(InData))
+{
+}
+
 bool FKaosGameplayAttributeChangedEventWrapperSpecHandle::operator==(FKaosGameplayAttributeChangedEventWrapperSpecHandle const& Other) const
 {
 	const bool bBothValid = Data.IsValid() && Other.Data.IsValid();
@@ -318,6 +500,26 @@ FKaosAbilitySetHandle UKaosUtilitiesBlueprintLibrary::GiveAbilitySetToInterface(
 	return Set->GiveAbilitySetToInterface(AbilitySystemInterface, OptionalOverrideSourceObject);
 }
 
+void UKaosUtilitiesBlueprintLibrary::GiveAbilitySetToASCAsync(UAbilitySystemComponent* AbilitySystemComponent, UKaosGameplayAbilitySet* Set, FKaosOnAbilitySetGrantedDynamic OnGranted, UObject* OptionalOverrideSourceObject)
+{
+	if (!IsValid(Set))
+	{
+		UE_LOGFMT(LogKaosUtilities, Warning, "Tried to give ability set to AbilitySystemComponent {ASC} but the Ability Set is null", *GetNameSafe(AbilitySystemComponent));
+		return;
+	}
+
+	if (!IsValid(AbilitySystemComponent))
+	{
+		UE_LOGFMT(LogKaosUtilities, Warning, "Tried to give ability set {Set} with a null AbilitySystemComponent", Set->GetName());
+		return;
+	}
+
+	Set->GiveAbilitySetToAsync(AbilitySystemComponent, FKaosOnAbilitySetGrantedAsync::CreateLambda([OnGranted](const FKaosAbilitySetHandle& Handle, double LoadSeconds)
+	{
+		OnGranted.ExecuteIfBound(Handle, static_cast<float>(LoadSeconds));
+	}), OptionalOverrideSourceObject);
+}
+
 void UKaosUtilitiesBlueprintLibrary::TakeAbilitySet(FKaosAbilitySetHandle& AbilitySetHandle)
 {
 	if (!AbilitySetHandle.IsValid())
@@ -328,6 +530,23 @@ void UKaosUtilitiesBlueprintLibrary::TakeAbilitySet(FKaosAbilitySetHandle& Abili
 	AbilitySetHandle.RemoveSet();
 }
 
+FKaosAbilitySetHandle UKaosUtilitiesBlueprintLibrary::SwapAbilitySet(FKaosAbilitySetHandle& AbilitySetHandle, UKaosGameplayAbilitySet* NewSet, UObject* OptionalOverrideSourceObject)
+{
+	if (!IsValid(NewSet))
+	{
+		UE_LOGFMT(LogKaosUtilities, Warning, "Tried to swap ability set with handle {Handle} but the new Ability Set is null", AbilitySetHandle.GetHandleId());
+		return {};
+	}
+
+	if (!AbilitySetHandle.IsValid())
+	{
+		UE_LOGFMT(LogKaosUtilities, Warning, "Tried to swap to ability set {Set} with an invalid Ability Set Handle.", NewSet->GetName());
+		return {};
+	}
+
+	return UKaosGameplayAbilitySet::SwapAbilitySet(AbilitySetHandle, NewSet, OptionalOverrideSourceObject);
+}
+
 void UKaosUtilitiesBlueprintLibrary::RemoveAllAbilitySetsFromInterface(TScriptInterface<IAbilitySystemInterface> AbilitySystemInterface)
 {
 	UAbilitySystemComponent* ASC = Cast<UAbilitySystemComponent>(AbilitySystemInterface.GetObject());
@@ -458,35 +677,16 @@ bool UKaosUtilitiesBlueprintLibrary::IsAbilityActiveByClass(UAbilitySystemCompon
 	return false;
 }
 
-bool UKaosUtilitiesBlueprintLibrary::CanApplyAttributeModifiers(UAbilitySystemComponent* AbilitySystemComponent, FGameplayEffectSpec EffectSpec)
+bool UKaosUtilitiesBlueprintLibrary::CanApplyAttributeModifiers(UAbilitySystemComponent* AbilitySystemComponent, const FGameplayEffectSpec& EffectSpec)
 {
-	if (AbilitySystemComponent)
+	if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent))
 	{
-		EffectSpec.CalculateModifierMagnitudes();
-
-		for (int32 ModIdx = 0; ModIdx < EffectSpec.Modifiers.Num(); ++ModIdx)
-		{
-			const FGameplayModifierInfo& ModDef = EffectSpec.Def->Modifiers[ModIdx];
-			const FModifierSpec& ModSpec = EffectSpec.Modifiers[ModIdx];
-
-			// It only makes sense to check additive operators
-			if (ModDef.ModifierOp == EGameplayModOp::Additive)
-			{
-				if (!ModDef.Attribute.IsValid())
-				{
-					continue;
-				}
-				const UAttributeSet* Set = AbilitySystemComponent->GetAttributeSet(ModDef.Attribute.GetAttributeSetClass());
-				const float CurrentValue = ModDef.Attribute.GetNumericValueChecked(Set);
-				const float CostValue = ModSpec.GetEvaluatedMagnitude();
+		return KaosAbilitySystemComponent->CanApplyAttributeModifiers(EffectSpec);
+	}
 
-				if (CurrentValue + CostValue < 0.f)
-				{
-					return false;
-				}
-			}
-		}
-		return true;
+	if (AbilitySystemComponent)
+	{
+		return UKaosAbilitySystemGlobals::CanApplyAttributeModifiers(*AbilitySystemComponent, EffectSpec);
 	}
 	return false;
 }
@@ -510,7 +710,8 @@ void UKaosUtilitiesBlueprintLibrary::UnblockAbilitiesWithTags(UAbilitySystemComp
 
 FKaosGameplayAttributeChangedEventWrapperSpecHandle UKaosUtilitiesBlueprintLibrary::BindEventWrapperToAttributeChangedKaos(
 	UAbilitySystemComponent* AbilitySystemComponent, FGameplayAttribute Attribute,
-	FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate, bool bExecuteForCurrentValueImmediately)
+	FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate, bool bExecuteForCurrentValueImmediately,
+	EKaosAttributeChangedDelivery Delivery, float DeliveryRateHz)
 {
 	if (!::IsValid(AbilitySystemComponent))
 	{
@@ -523,18 +724,11 @@ FKaosGameplayAttributeChangedEventWrapperSpecHandle UKaosUtilitiesBlueprintLibra
 		UE_LOG(LogAbilitySystem, Warning, TEXT("Tried to bind to an attribute that the owner does not have. Will still bind."));
 	}
 
-	FKaosGameplayAttributeChangedEventWrapperSpec* AttributeBindingSpec = new FKaosGameplayAttributeChangedEventWrapperSpec(AbilitySystemComponent, GameplayAttributeChangedEventWrapperDelegate);
+	const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> AttributeBindingSpec = FKaosGameplayAttributeChangedEventWrapperSpec::Create(
+		AbilitySystemComponent, GameplayAttributeChangedEventWrapperDelegate, Delivery, DeliveryRateHz);
 	FKaosGameplayAttributeChangedEventWrapperSpecHandle AttributeBindingHandle(AttributeBindingSpec);
 
-	// Bind to the ASC's attribute change listening delegate (which is not a 'dynamic' delegate and thereby can't be used in BP).
-	const FDelegateHandle AttributeChangedDelegateHandle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).AddLambda(
-		[GameplayAttributeChangedEventWrapperDelegate]
-		(const FOnAttributeChangeData& ChangeData)
-	{
-		ProcessGameplayAttributeChangedEventWrapper(ChangeData, GameplayAttributeChangedEventWrapperDelegate);
-	});
-
-	AttributeBindingSpec->DelegateBindings.Add(Attribute, AttributeChangedDelegateHandle);
+	AttributeBindingSpec->Bind(Attribute);
 
 	if (bExecuteForCurrentValueImmediately)
 	{
@@ -547,14 +741,16 @@ FKaosGameplayAttributeChangedEventWrapperSpecHandle UKaosUtilitiesBlueprintLibra
 
 FKaosGameplayAttributeChangedEventWrapperSpecHandle UKaosUtilitiesBlueprintLibrary::BindEventWrapperToAnyOfGameplayAttributesChangedKaos(
 	UAbilitySystemComponent* AbilitySystemComponent, const TArray<FGameplayAttribute>& Attributes,
-	FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate, bool bExecuteForCurrentValueImmediately)
+	FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate, bool bExecuteForCurrentValueImmediately,
+	EKaosAttributeChangedDelivery Delivery, float DeliveryRateHz)
 {
 	if (!::IsValid(AbilitySystemComponent))
 	{
 		return FKaosGameplayAttributeChangedEventWrapperSpecHandle();
 	}
 
-	FKaosGameplayAttributeChangedEventWrapperSpec* AttributeBindingSpec = new FKaosGameplayAttributeChangedEventWrapperSpec(AbilitySystemComponent, GameplayAttributeChangedEventWrapperDelegate);
+	const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> AttributeBindingSpec = FKaosGameplayAttributeChangedEventWrapperSpec::Create(
+		AbilitySystemComponent, GameplayAttributeChangedEventWrapperDelegate, Delivery, DeliveryRateHz);
 	FKaosGameplayAttributeChangedEventWrapperSpecHandle AttributeBindingHandle(AttributeBindingSpec);
 
 	AttributeBindingSpec->DelegateBindings.Reserve(Attributes.Num());
@@ -568,15 +764,7 @@ FKaosGameplayAttributeChangedEventWrapperSpecHandle UKaosUtilitiesBlueprintLibra
 			UE_LOG(LogAbilitySystem, Warning, TEXT("Tried to bind to an attribute that the owner does not have. Will still bind."));
 		}
 		
-		// Bind to the ASC's attribute change listening delegate (which is not a 'dynamic' delegate and thereby can't be used in BP).
-		const FDelegateHandle AttributeChangedDelegateHandle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).AddLambda(
-			[GameplayAttributeChangedEventWrapperDelegate]
-			(const FOnAttributeChangeData& ChangeData)
-		{
-			ProcessGameplayAttributeChangedEventWrapper(ChangeData, GameplayAttributeChangedEventWrapperDelegate);
-		});
-
-		AttributeBindingSpec->DelegateBindings.Add(Attribute, AttributeChangedDelegateHandle);
+		AttributeBindingSpec->Bind(Attribute);
 	}
 
 	if (bExecuteForCurrentValueImmediately)
@@ -599,18 +787,7 @@ void UKaosUtilitiesBlueprintLibrary::UnbindAllGameplayAttributeChangedEventWrapp
 		return;
 	}
 
-	UAbilitySystemComponent* AbilitySystemComponent = GameplayAttributeChangedEventDataPtr->AbilitySystemComponentWk.Get();
-	if (AbilitySystemComponent == nullptr)
-	{
-		return;
-	}
-
-	for (const auto& [Attribute, BoundHandle] : GameplayAttributeChangedEventDataPtr->DelegateBindings)
-	{
-		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).Remove(BoundHandle);
-	}
-
-	GameplayAttributeChangedEventDataPtr->DelegateBindings.Reset();
+	GameplayAttributeChangedEventDataPtr->UnbindAll();
 }
 
 void UKaosUtilitiesBlueprintLibrary::UnbindGameplayAttributeChangedEventWrapperForHandleKaos(FGameplayAttribute Attribute,
@@ -622,17 +799,7 @@ void UKaosUtilitiesBlueprintLibrary::UnbindGameplayAttributeChangedEventWrapperF
 		return;
 	}
 
-	UAbilitySystemComponent* AbilitySystemComponent = GameplayAttributeChangedEventDataPtr->AbilitySystemComponentWk.Get();
-	if (AbilitySystemComponent == nullptr)
-	{
-		return;
-	}
-
-	for (auto DelegateBindingIterator = GameplayAttributeChangedEventDataPtr->DelegateBindings.CreateIterator(); DelegateBindingIterator; ++DelegateBindingIterator)
-	{
-		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(DelegateBindingIterator->Key).Remove(DelegateBindingIterator->Value);
-		DelegateBindingIterator.RemoveCurrent();
-	}
+	GameplayAttributeChangedEventDataPtr->Unbind(Attribute);
 }
 
 void UKaosUtilitiesBlueprintLibrary::ProcessGameplayAttributeChangedEventWrapper(const FOnAttributeChangeData& Attribute,
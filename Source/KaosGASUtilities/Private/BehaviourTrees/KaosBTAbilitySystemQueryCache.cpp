@@ -0,0 +1,276 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "GameplayEffect.h"
+#include "Abilities/GameplayAbility.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
+
+namespace KaosBTAbilitySystemQueryCache
+{
+	enum class EQuery : uint8
+	{
+		HasAbility,
+		CanActivate,
+		IsActive,
+		IsOnCooldown
+	};
+
+	/** Frames an ability system component may go unqueried before its entry and event bindings are released */
+	static constexpr uint64 EntryTimeoutFrames = 60;
+
+	struct FEntry
+	{
+		TWeakObjectPtr<UAbilitySystemComponent> AbilitySystemComponent;
+
+		FDelegateHandle GameplayTagChangedHandle;
+		FDelegateHandle AbilityActivatedHandle;
+		FDelegateHandle AbilityEndedHandle;
+		FDelegateHandle AbilityGrantedHandle;
+		FDelegateHandle AbilityRemovedHandle;
+		FDelegateHandle AbilityBlockTagsChangedHandle;
+
+		/** Attributes modified by the cost effects of abilities queried for activation, their changes can flip CanActivate */
+		TArray<TTuple<FGameplayAttribute, FDelegateHandle>, TInlineAllocator<2>> CostAttributeHandles;
+
+		/** Frame Results were computed in */
+		uint64 ResultsFrame = 0;
+		uint64 LastUsedFrame = 0;
+		TMap<TTuple<FGameplayTag, EQuery>, bool> Results;
+	};
+
+	struct FCache
+	{
+		TMap<TObjectKey<AActor>, TWeakObjectPtr<UAbilitySystemComponent>> ResolvedComponents;
+		uint64 ResolvedComponentsFrame = 0;
+
+		TMap<TObjectKey<UAbilitySystemComponent>, FEntry> Entries;
+		uint64 LastPruneFrame = 0;
+	};
+
+	static FCache& Get()
+	{
+		check(IsInGameThread());
+		static FCache Cache;
+		return Cache;
+	}
+
+	static void ResetResults(TObjectKey<UAbilitySystemComponent> Key)
+	{
+		if (FEntry* Entry = Get().Entries.Find(Key))
+		{
+			Entry->Results.Reset();
+		}
+	}
+
+	static void UnbindEntry(FEntry& Entry)
+	{
+		UAbilitySystemComponent* AbilitySystemComponent = Entry.AbilitySystemComponent.Get();
+		if (!AbilitySystemComponent)
+		{
+			return;
+		}
+
+		AbilitySystemComponent->RegisterGenericGameplayTagEvent().Remove(Entry.GameplayTagChangedHandle);
+		AbilitySystemComponent->AbilityActivatedCallbacks.Remove(Entry.AbilityActivatedHandle);
+		AbilitySystemComponent->AbilityEndedCallbacks.Remove(Entry.AbilityEndedHandle);
+		for (const TTuple<FGameplayAttribute, FDelegateHandle>& CostAttributeHandle : Entry.CostAttributeHandles)
+		{
+			AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(CostAttributeHandle.Key).Remove(CostAttributeHandle.Value);
+		}
+		if (UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent))
+		{
+			KaosASC->OnAbilityGranted.Remove(Entry.AbilityGrantedHandle);
+			KaosASC->OnAbilityRemoved.Remove(Entry.AbilityRemovedHandle);
+			KaosASC->OnAbilityBlockTagsChanged.Remove(Entry.AbilityBlockTagsChangedHandle);
+		}
+	}
+
+	/** Releases entries of destroyed or no longer queried components, checked once every EntryTimeoutFrames */
+	static void PruneEntries(FCache& Cache)
+	{
+		if (GFrameCounter - Cache.LastPruneFrame < EntryTimeoutFrames)
+		{
+			return;
+		}
+		Cache.LastPruneFrame = GFrameCounter;
+
+		for (auto It = Cache.Entries.CreateIterator(); It; ++It)
+		{
+			if (!It->Value.AbilitySystemComponent.IsValid() || GFrameCounter - It->Value.LastUsedFrame >= EntryTimeoutFrames)
+			{
+				UnbindEntry(It->Value);
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	static FEntry& FindOrAddEntry(UAbilitySystemComponent& AbilitySystemComponent)
+	{
+		FCache& Cache = Get();
+		PruneEntries(Cache);
+
+		const TObjectKey<UAbilitySystemComponent> Key(&AbilitySystemComponent);
+		FEntry* Entry = Cache.Entries.Find(Key);
+		if (!Entry)
+		{
+			Entry = &Cache.Entries.Add(Key);
+			Entry->AbilitySystemComponent = &AbilitySystemComponent;
+			Entry->GameplayTagChangedHandle = AbilitySystemComponent.RegisterGenericGameplayTagEvent().AddLambda([Key](const FGameplayTag, int32) { ResetResults(Key); });
+			Entry->AbilityActivatedHandle = AbilitySystemComponent.AbilityActivatedCallbacks.AddLambda([Key](UGameplayAbility*) { ResetResults(Key); });
+			Entry->AbilityEndedHandle = AbilitySystemComponent.AbilityEndedCallbacks.AddLambda([Key](UGameplayAbility*) { ResetResults(Key); });
+			if (UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(&AbilitySystemComponent))
+			{
+				Entry->AbilityGrantedHandle = KaosASC->OnAbilityGranted.AddLambda([Key](const FGameplayAbilitySpec&) { ResetResults(Key); });
+				Entry->AbilityRemovedHandle = KaosASC->OnAbilityRemoved.AddLambda([Key](const FGameplayAbilitySpec&) { ResetResults(Key); });
+				Entry->AbilityBlockTagsChangedHandle = KaosASC->OnAbilityBlockTagsChanged.AddLambda([Key]() { ResetResults(Key); });
+			}
+		}
+
+		if (Entry->ResultsFrame != GFrameCounter)
+		{
+			Entry->ResultsFrame = GFrameCounter;
+			Entry->Results.Reset();
+		}
+		Entry->LastUsedFrame = GFrameCounter;
+		return *Entry;
+	}
+
+	/** Binds the attributes the cost of Ability modifies, the entry stays bound to them until it is released */
+	static void BindCostAttributes(FEntry& Entry, UAbilitySystemComponent& AbilitySystemComponent, const UGameplayAbility& Ability)
+	{
+		const UGameplayEffect* CostEffect = Ability.GetCostGameplayEffect();
+		if (!CostEffect)
+		{
+			return;
+		}
+
+		const TObjectKey<UAbilitySystemComponent> Key(&AbilitySystemComponent);
+		for (const FGameplayModifierInfo& Modifier : CostEffect->Modifiers)
+		{
+			if (Modifier.Attribute.IsValid() && !Entry.CostAttributeHandles.ContainsByPredicate([&Modifier](const TTuple<FGameplayAttribute, FDelegateHandle>& Existing) { return Existing.Key == Modifier.Attribute; }))
+			{
+				const FDelegateHandle CostAttributeHandle = AbilitySystemComponent.GetGameplayAttributeValueChangeDelegate(Modifier.Attribute).AddLambda([Key](const FOnAttributeChangeData&) { ResetResults(Key); });
+				Entry.CostAttributeHandles.Emplace(Modifier.Attribute, CostAttributeHandle);
+			}
+		}
+	}
+
+	static bool Evaluate(FEntry& Entry, UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag, EQuery Query)
+	{
+		FGameplayTagContainer CooldownTags;
+		for (const FGameplayAbilitySpec& Spec : AbilitySystemComponent.GetActivatableAbilities())
+		{
+			if (Spec.Ability == nullptr || !Spec.Ability->GetAssetTags().HasTag(AbilityTag))
+			{
+				continue;
+			}
+
+			switch (Query)
+			{
+			case EQuery::HasAbility:
+				return true;
+			case EQuery::CanActivate:
+				// Regenerating or spending a cost attribute can change the result without any tag changing
+				BindCostAttributes(Entry, AbilitySystemComponent, *Spec.Ability);
+				return Spec.Ability->CanActivateAbility(Spec.Handle, AbilitySystemComponent.AbilityActorInfo.Get());
+			case EQuery::IsActive:
+				if (Spec.IsActive())
+				{
+					return true;
+				}
+				break;
+			case EQuery::IsOnCooldown:
+				if (const FGameplayTagContainer* SpecCooldownTags = Spec.Ability->GetCooldownTags())
+				{
+					CooldownTags.AppendTags(*SpecCooldownTags);
+				}
+				break;
+			}
+		}
+
+		// Cooldown effects grant their cooldown tags for as long as they are active, so the tags alone answer the question
+		return Query == EQuery::IsOnCooldown && AbilitySystemComponent.HasAnyMatchingGameplayTags(CooldownTags);
+	}
+
+	static bool FindOrEvaluate(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag, EQuery Query)
+	{
+		FEntry& Entry = FindOrAddEntry(AbilitySystemComponent);
+		const TTuple<FGameplayTag, EQuery> ResultKey(AbilityTag, Query);
+		if (const bool* Result = Entry.Results.Find(ResultKey))
+		{
+			return *Result;
+		}
+
+		// Evaluating can not raise the events that reset the results, so the entry is still valid to add to
+		const bool bResult = Evaluate(Entry, AbilitySystemComponent, AbilityTag, Query);
+		Entry.Results.Add(ResultKey, bResult);
+		return bResult;
+	}
+}
+
+UAbilitySystemComponent* FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(const AActor* Actor)
+{
+	using namespace KaosBTAbilitySystemQueryCache;
+
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	FCache& Cache = Get();
+	if (Cache.ResolvedComponentsFrame != GFrameCounter)
+	{
+		Cache.ResolvedComponentsFrame = GFrameCounter;
+		Cache.ResolvedComponents.Reset();
+	}
+
+	const TObjectKey<AActor> Key(Actor);
+	if (const TWeakObjectPtr<UAbilitySystemComponent>* ResolvedComponent = Cache.ResolvedComponents.Find(Key))
+	{
+		return ResolvedComponent->Get();
+	}
+
+	UAbilitySystemComponent* AbilitySystemComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Actor);
+	Cache.ResolvedComponents.Add(Key, AbilitySystemComponent);
+	return AbilitySystemComponent;
+}
+
+bool FKaosBTAbilitySystemQueryCache::HasAbilityWithTag(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag)
+{
+	return KaosBTAbilitySystemQueryCache::FindOrEvaluate(AbilitySystemComponent, AbilityTag, KaosBTAbilitySystemQueryCache::EQuery::HasAbility);
+}
+
+bool FKaosBTAbilitySystemQueryCache::CanActivateAbilityWithTag(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag)
+{
+	return KaosBTAbilitySystemQueryCache::FindOrEvaluate(AbilitySystemComponent, AbilityTag, KaosBTAbilitySystemQueryCache::EQuery::CanActivate);
+}
+
+bool FKaosBTAbilitySystemQueryCache::IsAbilityWithTagActive(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag)
+{
+	return KaosBTAbilitySystemQueryCache::FindOrEvaluate(AbilitySystemComponent, AbilityTag, KaosBTAbilitySystemQueryCache::EQuery::IsActive);
+}
+
+bool FKaosBTAbilitySystemQueryCache::IsAbilityWithTagOnCooldown(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag)
+{
+	return KaosBTAbilitySystemQueryCache::FindOrEvaluate(AbilitySystemComponent, AbilityTag, KaosBTAbilitySystemQueryCache::EQuery::IsOnCooldown);
+}
@@ -20,11 +20,32 @@
 
 #include "BehaviourTrees/KaosBTDecorator_CanActivateAbility.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
-#include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
+#include "Abilities/GameplayAbility.h"
+#include "GameplayEffect.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 
+struct FKaosBTDecorator_CanActivateAbilityMemory
+{
+	TWeakObjectPtr<UKaosAbilitySystemComponent> CachedAbilitySystemComponent;
+
+	/** Spec matching AbilityTag, invalid if none is granted */
+	FGameplayAbilitySpecHandle CachedSpecHandle;
+
+	FDelegateHandle AbilityGrantedHandle;
+	FDelegateHandle AbilityRemovedHandle;
+	FDelegateHandle AbilityBlockTagsChangedHandle;
+	FDelegateHandle GameplayTagChangedHandle;
+
+	/** Attributes modified by the cached spec's cost effect */
+	TArray<TTuple<FGameplayAttribute, FDelegateHandle>> CostAttributeHandles;
+
+	bool bCanActivate = false;
+	bool bHasCachedResult = false;
+};
+
 UKaosBTDecorator_CanActivateAbility::UKaosBTDecorator_CanActivateAbility(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	NodeName = "Kaos Can Activate Ability";
@@ -40,6 +61,12 @@ UKaosBTDecorator_CanActivateAbility::UKaosBTDecorator_CanActivateAbility(const F
 
 bool UKaosBTDecorator_CanActivateAbility::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	const FKaosBTDecorator_CanActivateAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory);
+	if (MyMemory->bHasCachedResult)
+	{
+		return MyMemory->bCanActivate;
+	}
+
 	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
@@ -52,13 +79,159 @@ bool UKaosBTDecorator_CanActivateAbility::CalculateRawConditionValue(UBehaviorTr
 		return false;
 	}
 
-	UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
 	if (!ASC)
 	{
 		return false;
 	}
 
-	return UKaosUtilitiesBlueprintLibrary::CanActivateAbilityWithMatchingTags(ASC, FGameplayTagContainer(AbilityTag));
+	return FKaosBTAbilitySystemQueryCache::CanActivateAbilityWithTag(*ASC, AbilityTag);
+}
+
+const FGameplayAbilitySpec* UKaosBTDecorator_CanActivateAbility::FindMatchingSpec(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayAbilitySpecHandle& ExcludedHandle) const
+{
+	for (const FGameplayAbilitySpec& Spec : AbilitySystemComponent.GetActivatableAbilities())
+	{
+		if (Spec.Ability != nullptr && Spec.Handle != ExcludedHandle && Spec.Ability->GetAssetTags().HasTag(AbilityTag))
+		{
+			return &Spec;
+		}
+	}
+	return nullptr;
+}
+
+bool UKaosBTDecorator_CanActivateAbility::CanActivateSpec(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayAbilitySpec* Spec) const
+{
+	return Spec && Spec->Ability && Spec->Ability->CanActivateAbility(Spec->Handle, AbilitySystemComponent.AbilityActorInfo.Get());
+}
+
+void UKaosBTDecorator_CanActivateAbility::RefreshCachedResult(TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory, bool bResolveSpec, const FGameplayAbilitySpecHandle& ExcludedHandle)
+{
+	FKaosBTDecorator_CanActivateAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory);
+	UKaosAbilitySystemComponent* ASC = MyMemory->CachedAbilitySystemComponent.Get();
+	if (!ASC)
+	{
+		return;
+	}
+
+	const FGameplayAbilitySpec* Spec = nullptr;
+	if (bResolveSpec)
+	{
+		for (const TTuple<FGameplayAttribute, FDelegateHandle>& CostAttributeHandle : MyMemory->CostAttributeHandles)
+		{
+			ASC->GetGameplayAttributeValueChangeDelegate(CostAttributeHandle.Key).Remove(CostAttributeHandle.Value);
+		}
+		MyMemory->CostAttributeHandles.Reset();
+
+		Spec = FindMatchingSpec(*ASC, ExcludedHandle);
+		MyMemory->CachedSpecHandle = Spec ? Spec->Handle : FGameplayAbilitySpecHandle();
+
+		// Regenerating or spending a cost attribute can change the result without any tag changing
+		const UGameplayEffect* CostEffect = Spec && Spec->Ability ? Spec->Ability->GetCostGameplayEffect() : nullptr;
+		if (CostEffect)
+		{
+			for (const FGameplayModifierInfo& Modifier : CostEffect->Modifiers)
+			{
+				if (Modifier.Attribute.IsValid() && !MyMemory->CostAttributeHandles.ContainsByPredicate([&Modifier](const TTuple<FGameplayAttribute, FDelegateHandle>& Existing) { return Existing.Key == Modifier.Attribute; }))
+				{
+					FDelegateHandle CostAttributeHandle = ASC->GetGameplayAttributeValueChangeDelegate(Modifier.Attribute).AddUObject(
+						this, &UKaosBTDecorator_CanActivateAbility::OnCostAttributeChanged, BehaviorTreeComponent, NodeMemory);
+					MyMemory->CostAttributeHandles.Emplace(Modifier.Attribute, CostAttributeHandle);
+				}
+			}
+		}
+	}
+	else
+	{
+		Spec = ASC->FindAbilitySpecFromHandle(MyMemory->CachedSpecHandle);
+	}
+
+	const bool bCanActivate = CanActivateSpec(*ASC, Spec);
+	const bool bResultChanged = MyMemory->bHasCachedResult && MyMemory->bCanActivate != bCanActivate;
+	MyMemory->bCanActivate = bCanActivate;
+	MyMemory->bHasCachedResult = true;
+
+	if (bResultChanged && BehaviorTreeComponent.IsValid())
+	{
+		ConditionalFlowAbort(*BehaviorTreeComponent, EBTDecoratorAbortRequest::ConditionResultChanged);
+	}
+}
+
+void UKaosBTDecorator_CanActivateAbility::OnAbilitySpecChanged(const FGameplayAbilitySpec& AbilitySpec, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory, bool bRemoved)
+{
+	const FKaosBTDecorator_CanActivateAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory);
+	const bool bIsCachedSpec = AbilitySpec.Handle == MyMemory->CachedSpecHandle;
+	const bool bMatchesTag = AbilitySpec.Ability != nullptr && AbilitySpec.Ability->GetAssetTags().HasTag(AbilityTag);
+	if (bIsCachedSpec || bMatchesTag)
+	{
+		// A removed spec is still in the activatable abilities while the event runs
+		RefreshCachedResult(BehaviorTreeComponent, NodeMemory, true, bRemoved ? AbilitySpec.Handle : FGameplayAbilitySpecHandle());
+	}
+}
+
+void UKaosBTDecorator_CanActivateAbility::OnAbilityBlockTagsChanged(TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory)
+{
+	RefreshCachedResult(BehaviorTreeComponent, NodeMemory, false, FGameplayAbilitySpecHandle());
+}
+
+void UKaosBTDecorator_CanActivateAbility::OnGameplayTagChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory)
+{
+	RefreshCachedResult(BehaviorTreeComponent, NodeMemory, false, FGameplayAbilitySpecHandle());
+}
+
+void UKaosBTDecorator_CanActivateAbility::OnCostAttributeChanged(const FOnAttributeChangeData& ChangeData, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory)
+{
+	RefreshCachedResult(BehaviorTreeComponent, NodeMemory, false, FGameplayAbilitySpecHandle());
+}
+
+void UKaosBTDecorator_CanActivateAbility::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	if (!BlackboardComp)
+	{
+		// Not calling super here since it does nothing
+		return;
+	}
+
+	const AActor* SelectedActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForAbilityActivation.GetSelectedKeyID()));
+
+	// Only the Kaos ASC reports granted and removed abilities, other components are evaluated on every check
+	UKaosAbilitySystemComponent* ASC = Cast<UKaosAbilitySystemComponent>(FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor));
+	if (!ASC)
+	{
+		// Not calling super here since it does nothing
+		return;
+	}
+
+	FKaosBTDecorator_CanActivateAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory);
+	MyMemory->CachedAbilitySystemComponent = ASC;
+
+	const TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent(&OwnerComp);
+	MyMemory->AbilityGrantedHandle = ASC->OnAbilityGranted.AddUObject(this, &UKaosBTDecorator_CanActivateAbility::OnAbilitySpecChanged, BehaviorTreeComponent, NodeMemory, false);
+	MyMemory->AbilityRemovedHandle = ASC->OnAbilityRemoved.AddUObject(this, &UKaosBTDecorator_CanActivateAbility::OnAbilitySpecChanged, BehaviorTreeComponent, NodeMemory, true);
+	MyMemory->AbilityBlockTagsChangedHandle = ASC->OnAbilityBlockTagsChanged.AddUObject(this, &UKaosBTDecorator_CanActivateAbility::OnAbilityBlockTagsChanged, BehaviorTreeComponent, NodeMemory);
+	MyMemory->GameplayTagChangedHandle = ASC->RegisterGenericGameplayTagEvent().AddUObject(this, &UKaosBTDecorator_CanActivateAbility::OnGameplayTagChanged, BehaviorTreeComponent, NodeMemory);
+
+	RefreshCachedResult(BehaviorTreeComponent, NodeMemory, true, FGameplayAbilitySpecHandle());
+}
+
+void UKaosBTDecorator_CanActivateAbility::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FKaosBTDecorator_CanActivateAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory);
+
+	if (UKaosAbilitySystemComponent* ASC = MyMemory->CachedAbilitySystemComponent.Get())
+	{
+		ASC->OnAbilityGranted.Remove(MyMemory->AbilityGrantedHandle);
+		ASC->OnAbilityRemoved.Remove(MyMemory->AbilityRemovedHandle);
+		ASC->OnAbilityBlockTagsChanged.Remove(MyMemory->AbilityBlockTagsChangedHandle);
+		ASC->RegisterGenericGameplayTagEvent().Remove(MyMemory->GameplayTagChangedHandle);
+		for (const TTuple<FGameplayAttribute, FDelegateHandle>& CostAttributeHandle : MyMemory->CostAttributeHandles)
+		{
+			ASC->GetGameplayAttributeValueChangeDelegate(CostAttributeHandle.Key).Remove(CostAttributeHandle.Value);
+		}
+	}
+
+	*MyMemory = FKaosBTDecorator_CanActivateAbilityMemory();
 }
 
 void UKaosBTDecorator_CanActivateAbility::InitializeFromAsset(UBehaviorTree& Asset)
@@ -75,3 +248,18 @@ FString UKaosBTDecorator_CanActivateAbility::GetStaticDescription() const
 {
 	return FString::Printf(TEXT("%s: AbilityTag: %s"), *Super::GetStaticDescription(), *AbilityTag.ToString());
 }
+
+uint16 UKaosBTDecorator_CanActivateAbility::GetInstanceMemorySize() const
+{
+	return sizeof(FKaosBTDecorator_CanActivateAbilityMemory);
+}
+
+void UKaosBTDecorator_CanActivateAbility::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory, InitType);
+}
+
+void UKaosBTDecorator_CanActivateAbility::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FKaosBTDecorator_CanActivateAbilityMemory>(NodeMemory, CleanupType);
+}
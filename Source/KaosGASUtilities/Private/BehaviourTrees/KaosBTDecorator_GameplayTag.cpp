@@ -20,7 +20,7 @@
 
 #include "BehaviourTrees/KaosBTDecorator_GameplayTag.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
 #include "GameplayTagAssetInterface.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
@@ -31,6 +31,10 @@ struct FKaosBTDecorator_GameplayTagMemory
 
 	/** Array of handles for our gameplay tag query delegates */
 	TArray<TTuple<FGameplayTag, FDelegateHandle>> GameplayTagEventHandles;
+
+	/** Last condition result while relevant, invalidated by the registered tag events */
+	bool bCachedResult = false;
+	bool bHasCachedResult = false;
 };
 
 UKaosBTDecorator_GameplayTag::UKaosBTDecorator_GameplayTag(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -51,13 +55,13 @@ bool UKaosBTDecorator_GameplayTag::MatchContainer(const FGameplayTagContainer& S
 	switch (GameplayTagContainerMatchingType)
 	{
 	case EKaosBTDecoratorGameplayTagContainerMatching::HasAny:
-		return GameplayTags.HasAny(GameplayTags);
+		return SelectedGameplayTags.HasAny(GameplayTags);
 	case EKaosBTDecoratorGameplayTagContainerMatching::HasAll:
-		return GameplayTags.HasAll(GameplayTags);
+		return SelectedGameplayTags.HasAll(GameplayTags);
 	case EKaosBTDecoratorGameplayTagContainerMatching::HasAnyExact:
-		return GameplayTags.HasAnyExact(GameplayTags);
+		return SelectedGameplayTags.HasAnyExact(GameplayTags);
 	case EKaosBTDecoratorGameplayTagContainerMatching::HasAllExact:
-		return GameplayTags.HasAllExact(GameplayTags);
+		return SelectedGameplayTags.HasAllExact(GameplayTags);
 	}
 	//Should never reach here.
 	ensureMsgf(false, TEXT("No valid enum for GameplayTagContainerMatchingType"));
@@ -66,6 +70,20 @@ bool UKaosBTDecorator_GameplayTag::MatchContainer(const FGameplayTagContainer& S
 
 bool UKaosBTDecorator_GameplayTag::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	FKaosBTDecorator_GameplayTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagMemory>(NodeMemory);
+	if (MyMemory->bHasCachedResult)
+	{
+		return MyMemory->bCachedResult;
+	}
+
+	// While relevant, match straight against the ASC's tags and keep the result until a tag event invalidates it
+	if (const UAbilitySystemComponent* CachedAbilitySystemComponent = MyMemory->CachedAbilitySystemComponent.Get())
+	{
+		MyMemory->bCachedResult = MatchTags(CachedAbilitySystemComponent->GetOwnedGameplayTags());
+		MyMemory->bHasCachedResult = true;
+		return MyMemory->bCachedResult;
+	}
+
 	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
@@ -73,7 +91,13 @@ bool UKaosBTDecorator_GameplayTag::CalculateRawConditionValue(UBehaviorTreeCompo
 		return false;
 	}
 
-	const IGameplayTagAssetInterface* GameplayTagAssetInterface = Cast<IGameplayTagAssetInterface>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagCheck.GetSelectedKeyID()));
+	UObject* SelectedObject = BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagCheck.GetSelectedKeyID());
+	if (const UAbilitySystemComponent* AbilitySystemComponent = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(Cast<AActor>(SelectedObject)))
+	{
+		return MatchTags(AbilitySystemComponent->GetOwnedGameplayTags());
+	}
+
+	const IGameplayTagAssetInterface* GameplayTagAssetInterface = Cast<IGameplayTagAssetInterface>(SelectedObject);
 	if (!GameplayTagAssetInterface)
 	{
 		// Not calling super here since it returns true
@@ -82,7 +106,11 @@ bool UKaosBTDecorator_GameplayTag::CalculateRawConditionValue(UBehaviorTreeCompo
 
 	FGameplayTagContainer SelectedActorTags;
 	GameplayTagAssetInterface->GetOwnedGameplayTags(SelectedActorTags);
+	return MatchTags(SelectedActorTags);
+}
 
+bool UKaosBTDecorator_GameplayTag::MatchTags(const FGameplayTagContainer& SelectedActorTags) const
+{
 	switch (GameplayTagMatchType)
 	{
 	case EKaosBTDecoratorMatchType::GameplayTag:
@@ -98,6 +126,8 @@ bool UKaosBTDecorator_GameplayTag::CalculateRawConditionValue(UBehaviorTreeCompo
 
 void UKaosBTDecorator_GameplayTag::OnGameplayTagsChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory)
 {
+	CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagMemory>(NodeMemory)->bHasCachedResult = false;
+
 	if (!BehaviorTreeComponent.IsValid())
 	{
 		return;
@@ -135,7 +165,7 @@ void UKaosBTDecorator_GameplayTag::CleanupMemory(UBehaviorTreeComponent& OwnerCo
 
 void UKaosBTDecorator_GameplayTag::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
 		// Not calling super here since it does nothing
@@ -143,41 +173,57 @@ void UKaosBTDecorator_GameplayTag::OnBecomeRelevant(UBehaviorTreeComponent& Owne
 	}
 
 	const AActor* SelectedActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagCheck.GetSelectedKeyID()));
-	if (!SelectedActor)
+	BindGameplayTagEvents(OwnerComp, NodeMemory, SelectedActor);
+
+	// The cached ASC and tag events follow the actor key, so they are rebound when it changes
+	BlackboardComp->RegisterObserver(ActorForGameplayTagCheck.GetSelectedKeyID(), this, FOnBlackboardChangeNotification::CreateUObject(this, &UKaosBTDecorator_GameplayTag::OnBlackboardKeyValueChange));
+}
+
+void UKaosBTDecorator_GameplayTag::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	UnbindGameplayTagEvents(NodeMemory);
+
+	if (UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent())
 	{
-		// Not calling super here since it does nothing
-		return;
+		BlackboardComp->UnregisterObserversFrom(this);
 	}
+}
 
+void UKaosBTDecorator_GameplayTag::BindGameplayTagEvents(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, const AActor* SelectedActor)
+{
 	FKaosBTDecorator_GameplayTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagMemory>(NodeMemory);
-	MyMemory->CachedAbilitySystemComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	MyMemory->CachedAbilitySystemComponent = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
+	MyMemory->bHasCachedResult = false;
 
-	if (MyMemory->CachedAbilitySystemComponent.IsValid())
+	UAbilitySystemComponent* AbilitySystemComponent = MyMemory->CachedAbilitySystemComponent.Get();
+	if (!AbilitySystemComponent)
+	{
+		return;
+	}
+
+	switch (GameplayTagMatchType)
 	{
-		switch (GameplayTagMatchType)
+	case EKaosBTDecoratorMatchType::GameplayTag:
+		{
+			FDelegateHandle GameplayTagEventCallbackDelegate = AbilitySystemComponent->RegisterGameplayTagEvent(GameplayTag, EGameplayTagEventType::Type::AnyCountChange).AddUObject(
+				this, &UKaosBTDecorator_GameplayTag::OnGameplayTagsChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory);
+			MyMemory->GameplayTagEventHandles.Emplace(GameplayTag, GameplayTagEventCallbackDelegate);
+		}
+		break;
+	case EKaosBTDecoratorMatchType::GameplayTagContainer:
 		{
-		case EKaosBTDecoratorMatchType::GameplayTag:
+			for (const FGameplayTag& CurrentTag : GameplayTags)
 			{
-				FDelegateHandle GameplayTagEventCallbackDelegate = MyMemory->CachedAbilitySystemComponent.Get()->RegisterGameplayTagEvent(GameplayTag, EGameplayTagEventType::Type::AnyCountChange).AddUObject(
+				FDelegateHandle GameplayTagEventCallbackDelegate = AbilitySystemComponent->RegisterGameplayTagEvent(CurrentTag, EGameplayTagEventType::Type::AnyCountChange).AddUObject(
 					this, &UKaosBTDecorator_GameplayTag::OnGameplayTagsChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory);
-				MyMemory->GameplayTagEventHandles.Emplace(GameplayTag, GameplayTagEventCallbackDelegate);
-			}
-			break;
-		case EKaosBTDecoratorMatchType::GameplayTagContainer:
-			{
-				for (const FGameplayTag& CurrentTag : GameplayTags)
-				{
-					FDelegateHandle GameplayTagEventCallbackDelegate = MyMemory->CachedAbilitySystemComponent.Get()->RegisterGameplayTagEvent(CurrentTag, EGameplayTagEventType::Type::AnyCountChange).AddUObject(
-						this, &UKaosBTDecorator_GameplayTag::OnGameplayTagsChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory);
-					MyMemory->GameplayTagEventHandles.Emplace(CurrentTag, GameplayTagEventCallbackDelegate);
-				}
+				MyMemory->GameplayTagEventHandles.Emplace(CurrentTag, GameplayTagEventCallbackDelegate);
 			}
-			break;
 		}
+		break;
 	}
 }
 
-void UKaosBTDecorator_GameplayTag::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+void UKaosBTDecorator_GameplayTag::UnbindGameplayTagEvents(uint8* NodeMemory) const
 {
 	FKaosBTDecorator_GameplayTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagMemory>(NodeMemory);
 
@@ -191,6 +237,29 @@ void UKaosBTDecorator_GameplayTag::OnCeaseRelevant(UBehaviorTreeComponent& Owner
 
 	MyMemory->GameplayTagEventHandles.Reset();
 	MyMemory->CachedAbilitySystemComponent = nullptr;
+	MyMemory->bHasCachedResult = false;
+}
+
+EBlackboardNotificationResult UKaosBTDecorator_GameplayTag::OnBlackboardKeyValueChange(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKeyID)
+{
+	UBehaviorTreeComponent* BehaviorComp = Cast<UBehaviorTreeComponent>(Blackboard.GetBrainComponent());
+	if (!BehaviorComp)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	uint8* NodeMemory = BehaviorComp->GetNodeMemory(this, BehaviorComp->FindInstanceContainingNode(this));
+	if (!NodeMemory)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	// Move the tag events over to the new actor's ASC, the abort re-evaluates the condition against it
+	UnbindGameplayTagEvents(NodeMemory);
+	BindGameplayTagEvents(*BehaviorComp, NodeMemory, Cast<AActor>(Blackboard.GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagCheck.GetSelectedKeyID())));
+	ConditionalFlowAbort(*BehaviorComp, EBTDecoratorAbortRequest::ConditionResultChanged);
+
+	return EBlackboardNotificationResult::ContinueObserving;
 }
 
 uint16 UKaosBTDecorator_GameplayTag::GetInstanceMemorySize() const
@@ -20,7 +20,7 @@
 
 #include "BehaviourTrees/KaosBTDecorator_GameplayTagQuery.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 
@@ -32,6 +32,10 @@ struct FKaosBTDecorator_GameplayTagQueryMemory
 
 	/** Array of handles for our gameplay tag query delegates */
 	TArray<TTuple<FGameplayTag, FDelegateHandle>> GameplayTagEventHandles;
+
+	/** Last query result while relevant, invalidated by the registered tag events */
+	bool bCachedResult = false;
+	bool bHasCachedResult = false;
 };
 
 UKaosBTDecorator_GameplayTagQuery::UKaosBTDecorator_GameplayTagQuery(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
@@ -49,6 +53,20 @@ UKaosBTDecorator_GameplayTagQuery::UKaosBTDecorator_GameplayTagQuery(const FObje
 
 bool UKaosBTDecorator_GameplayTagQuery::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	FKaosBTDecorator_GameplayTagQueryMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagQueryMemory>(NodeMemory);
+	if (MyMemory->bHasCachedResult)
+	{
+		return MyMemory->bCachedResult;
+	}
+
+	// While relevant, match straight against the ASC's tags and keep the result until a tag event invalidates it
+	if (const UAbilitySystemComponent* CachedAbilitySystemComponent = MyMemory->CachedAbilitySystemComponent.Get())
+	{
+		MyMemory->bCachedResult = GameplayTagQuery.Matches(CachedAbilitySystemComponent->GetOwnedGameplayTags());
+		MyMemory->bHasCachedResult = true;
+		return MyMemory->bCachedResult;
+	}
+
 	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
@@ -56,7 +74,13 @@ bool UKaosBTDecorator_GameplayTagQuery::CalculateRawConditionValue(UBehaviorTree
 		return false;
 	}
 
-	const IGameplayTagAssetInterface* GameplayTagAssetInterface = Cast<IGameplayTagAssetInterface>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagQuery.GetSelectedKeyID()));
+	UObject* SelectedObject = BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagQuery.GetSelectedKeyID());
+	if (const UAbilitySystemComponent* AbilitySystemComponent = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(Cast<AActor>(SelectedObject)))
+	{
+		return GameplayTagQuery.Matches(AbilitySystemComponent->GetOwnedGameplayTags());
+	}
+
+	const IGameplayTagAssetInterface* GameplayTagAssetInterface = Cast<IGameplayTagAssetInterface>(SelectedObject);
 	if (!GameplayTagAssetInterface)
 	{
 		// Not calling super here since it returns true
@@ -71,6 +95,8 @@ bool UKaosBTDecorator_GameplayTagQuery::CalculateRawConditionValue(UBehaviorTree
 
 void UKaosBTDecorator_GameplayTagQuery::OnGameplayTagInQueryChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory)
 {
+	CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagQueryMemory>(NodeMemory)->bHasCachedResult = false;
+
 	if (!BehaviorTreeComponent.IsValid())
 	{
 		return;
@@ -100,27 +126,43 @@ void UKaosBTDecorator_GameplayTagQuery::OnBecomeRelevant(UBehaviorTreeComponent&
 	}
 
 	const AActor* SelectedActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagQuery.GetSelectedKeyID()));
-	if (!SelectedActor)
+	BindGameplayTagEvents(OwnerComp, NodeMemory, SelectedActor);
+
+	// The cached ASC and tag events follow the actor key, so they are rebound when it changes
+	BlackboardComp->RegisterObserver(ActorForGameplayTagQuery.GetSelectedKeyID(), this, FOnBlackboardChangeNotification::CreateUObject(this, &UKaosBTDecorator_GameplayTagQuery::OnBlackboardKeyValueChange));
+}
+
+void UKaosBTDecorator_GameplayTagQuery::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	UnbindGameplayTagEvents(NodeMemory);
+
+	if (UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent())
 	{
-		// Not calling super here since it does nothing
-		return;
+		BlackboardComp->UnregisterObserversFrom(this);
 	}
+}
 
+void UKaosBTDecorator_GameplayTagQuery::BindGameplayTagEvents(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, const AActor* SelectedActor)
+{
 	FKaosBTDecorator_GameplayTagQueryMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagQueryMemory>(NodeMemory);
-	MyMemory->CachedAbilitySystemComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	MyMemory->CachedAbilitySystemComponent = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
+	MyMemory->bHasCachedResult = false;
 
-	if (MyMemory->CachedAbilitySystemComponent.IsValid())
+	UAbilitySystemComponent* AbilitySystemComponent = MyMemory->CachedAbilitySystemComponent.Get();
+	if (!AbilitySystemComponent)
 	{
-		for (const FGameplayTag& CurrentTag : QueryTags)
-		{
-			FDelegateHandle GameplayTagEventCallbackDelegate = MyMemory->CachedAbilitySystemComponent.Get()->RegisterGameplayTagEvent(CurrentTag, EGameplayTagEventType::Type::AnyCountChange).AddUObject(
-				this, &UKaosBTDecorator_GameplayTagQuery::OnGameplayTagInQueryChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory);
-			MyMemory->GameplayTagEventHandles.Emplace(CurrentTag, GameplayTagEventCallbackDelegate);
-		}
+		return;
+	}
+
+	for (const FGameplayTag& CurrentTag : QueryTags)
+	{
+		FDelegateHandle GameplayTagEventCallbackDelegate = AbilitySystemComponent->RegisterGameplayTagEvent(CurrentTag, EGameplayTagEventType::Type::AnyCountChange).AddUObject(
+			this, &UKaosBTDecorator_GameplayTagQuery::OnGameplayTagInQueryChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory);
+		MyMemory->GameplayTagEventHandles.Emplace(CurrentTag, GameplayTagEventCallbackDelegate);
 	}
 }
 
-void UKaosBTDecorator_GameplayTagQuery::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+void UKaosBTDecorator_GameplayTagQuery::UnbindGameplayTagEvents(uint8* NodeMemory) const
 {
 	FKaosBTDecorator_GameplayTagQueryMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_GameplayTagQueryMemory>(NodeMemory);
 
@@ -134,6 +176,29 @@ void UKaosBTDecorator_GameplayTagQuery::OnCeaseRelevant(UBehaviorTreeComponent&
 
 	MyMemory->GameplayTagEventHandles.Reset();
 	MyMemory->CachedAbilitySystemComponent = nullptr;
+	MyMemory->bHasCachedResult = false;
+}
+
+EBlackboardNotificationResult UKaosBTDecorator_GameplayTagQuery::OnBlackboardKeyValueChange(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKeyID)
+{
+	UBehaviorTreeComponent* BehaviorComp = Cast<UBehaviorTreeComponent>(Blackboard.GetBrainComponent());
+	if (!BehaviorComp)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	uint8* NodeMemory = BehaviorComp->GetNodeMemory(this, BehaviorComp->FindInstanceContainingNode(this));
+	if (!NodeMemory)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	// Move the tag events over to the new actor's ASC, the abort re-evaluates the query against it
+	UnbindGameplayTagEvents(NodeMemory);
+	BindGameplayTagEvents(*BehaviorComp, NodeMemory, Cast<AActor>(Blackboard.GetValue<UBlackboardKeyType_Object>(ActorForGameplayTagQuery.GetSelectedKeyID())));
+	ConditionalFlowAbort(*BehaviorComp, EBTDecoratorAbortRequest::ConditionResultChanged);
+
+	return EBlackboardNotificationResult::ContinueObserving;
 }
 
 uint16 UKaosBTDecorator_GameplayTagQuery::GetInstanceMemorySize() const
@@ -20,11 +20,23 @@
 
 #include "BehaviourTrees/KaosBTDecorator_HasGameplayAbility.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
-#include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
+#include "Abilities/GameplayAbility.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 
+struct FKaosBTDecorator_HasGameplayAbilityMemory
+{
+	TWeakObjectPtr<UKaosAbilitySystemComponent> CachedAbilitySystemComponent;
+
+	FDelegateHandle AbilityGrantedHandle;
+	FDelegateHandle AbilityRemovedHandle;
+
+	bool bHasAbility = false;
+	bool bHasCachedResult = false;
+};
+
 UKaosBTDecorator_HasGameplayAbility::UKaosBTDecorator_HasGameplayAbility()
 {
 	NodeName = "Kaos Has Gameplay Ability";
@@ -40,6 +52,12 @@ UKaosBTDecorator_HasGameplayAbility::UKaosBTDecorator_HasGameplayAbility()
 
 bool UKaosBTDecorator_HasGameplayAbility::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	const FKaosBTDecorator_HasGameplayAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_HasGameplayAbilityMemory>(NodeMemory);
+	if (MyMemory->bHasCachedResult)
+	{
+		return MyMemory->bHasAbility;
+	}
+
 	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
@@ -52,13 +70,98 @@ bool UKaosBTDecorator_HasGameplayAbility::CalculateRawConditionValue(UBehaviorTr
 		return false;
 	}
 
-	UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
 	if (!ASC)
 	{
 		return false;
 	}
 
-	return UKaosUtilitiesBlueprintLibrary::HasAbilityWithAllTags(ASC, FGameplayTagContainer(AbilityTag));
+	return FKaosBTAbilitySystemQueryCache::HasAbilityWithTag(*ASC, AbilityTag);
+}
+
+bool UKaosBTDecorator_HasGameplayAbility::HasMatchingSpec(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayAbilitySpecHandle& ExcludedHandle) const
+{
+	for (const FGameplayAbilitySpec& Spec : AbilitySystemComponent.GetActivatableAbilities())
+	{
+		if (Spec.Ability != nullptr && Spec.Handle != ExcludedHandle && Spec.Ability->GetAssetTags().HasTag(AbilityTag))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UKaosBTDecorator_HasGameplayAbility::OnAbilitySpecChanged(const FGameplayAbilitySpec& AbilitySpec, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory, bool bRemoved)
+{
+	if (AbilitySpec.Ability == nullptr || !AbilitySpec.Ability->GetAssetTags().HasTag(AbilityTag))
+	{
+		return;
+	}
+
+	FKaosBTDecorator_HasGameplayAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_HasGameplayAbilityMemory>(NodeMemory);
+	const UKaosAbilitySystemComponent* ASC = MyMemory->CachedAbilitySystemComponent.Get();
+	if (!ASC)
+	{
+		return;
+	}
+
+	// A removed spec is still in the activatable abilities while the event runs, another matching spec may remain
+	const bool bHasAbility = !bRemoved || HasMatchingSpec(*ASC, AbilitySpec.Handle);
+	if (bHasAbility == MyMemory->bHasAbility)
+	{
+		return;
+	}
+	MyMemory->bHasAbility = bHasAbility;
+
+	if (!BehaviorTreeComponent.IsValid())
+	{
+		return;
+	}
+
+	ConditionalFlowAbort(*BehaviorTreeComponent, EBTDecoratorAbortRequest::ConditionResultChanged);
+}
+
+void UKaosBTDecorator_HasGameplayAbility::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	if (!BlackboardComp)
+	{
+		// Not calling super here since it does nothing
+		return;
+	}
+
+	const AActor* SelectedActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(TargetActorKey.GetSelectedKeyID()));
+
+	// Only the Kaos ASC reports granted and removed abilities, other components are evaluated on every check
+	UKaosAbilitySystemComponent* ASC = Cast<UKaosAbilitySystemComponent>(FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor));
+	if (!ASC)
+	{
+		// Not calling super here since it does nothing
+		return;
+	}
+
+	FKaosBTDecorator_HasGameplayAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_HasGameplayAbilityMemory>(NodeMemory);
+	MyMemory->CachedAbilitySystemComponent = ASC;
+
+	const TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent(&OwnerComp);
+	MyMemory->AbilityGrantedHandle = ASC->OnAbilityGranted.AddUObject(this, &UKaosBTDecorator_HasGameplayAbility::OnAbilitySpecChanged, BehaviorTreeComponent, NodeMemory, false);
+	MyMemory->AbilityRemovedHandle = ASC->OnAbilityRemoved.AddUObject(this, &UKaosBTDecorator_HasGameplayAbility::OnAbilitySpecChanged, BehaviorTreeComponent, NodeMemory, true);
+
+	MyMemory->bHasAbility = HasMatchingSpec(*ASC, FGameplayAbilitySpecHandle());
+	MyMemory->bHasCachedResult = true;
+}
+
+void UKaosBTDecorator_HasGameplayAbility::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FKaosBTDecorator_HasGameplayAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_HasGameplayAbilityMemory>(NodeMemory);
+
+	if (UKaosAbilitySystemComponent* ASC = MyMemory->CachedAbilitySystemComponent.Get())
+	{
+		ASC->OnAbilityGranted.Remove(MyMemory->AbilityGrantedHandle);
+		ASC->OnAbilityRemoved.Remove(MyMemory->AbilityRemovedHandle);
+	}
+
+	*MyMemory = FKaosBTDecorator_HasGameplayAbilityMemory();
 }
 
 FString UKaosBTDecorator_HasGameplayAbility::GetStaticDescription() const
@@ -76,3 +179,18 @@ void UKaosBTDecorator_HasGameplayAbility::InitializeFromAsset(UBehaviorTree& Ass
 		TargetActorKey.ResolveSelectedKey(*BBAsset);
 	}
 }
+
+uint16 UKaosBTDecorator_HasGameplayAbility::GetInstanceMemorySize() const
+{
+	return sizeof(FKaosBTDecorator_HasGameplayAbilityMemory);
+}
+
+void UKaosBTDecorator_HasGameplayAbility::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTDecorator_HasGameplayAbilityMemory>(NodeMemory, InitType);
+}
+
+void UKaosBTDecorator_HasGameplayAbility::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FKaosBTDecorator_HasGameplayAbilityMemory>(NodeMemory, CleanupType);
+}
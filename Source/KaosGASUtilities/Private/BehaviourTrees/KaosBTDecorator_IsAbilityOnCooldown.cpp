@@ -20,11 +20,26 @@
 
 #include "BehaviourTrees/KaosBTDecorator_IsAbilityOnCooldown.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
-#include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
+#include "Abilities/GameplayAbility.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 
+struct FKaosBTDecorator_IsAbilityOnCooldownMemory
+{
+	TWeakObjectPtr<UAbilitySystemComponent> CachedAbilitySystemComponent;
+
+	/** Cooldown tags of the matching abilities, resolved when the decorator becomes relevant */
+	FGameplayTagContainer CooldownTags;
+
+	/** Array of handles for our cooldown tag delegates */
+	TArray<TTuple<FGameplayTag, FDelegateHandle>> GameplayTagEventHandles;
+
+	/** Whether any cooldown tag is present, valid while relevant */
+	bool bIsOnCooldown = false;
+	bool bHasCachedResult = false;
+};
+
 UKaosBTDecorator_IsAbilityOnCooldown::UKaosBTDecorator_IsAbilityOnCooldown()
 {
 	NodeName = "Kaos Is Ability On Cooldown";
@@ -40,6 +55,12 @@ UKaosBTDecorator_IsAbilityOnCooldown::UKaosBTDecorator_IsAbilityOnCooldown()
 
 bool UKaosBTDecorator_IsAbilityOnCooldown::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	const FKaosBTDecorator_IsAbilityOnCooldownMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsAbilityOnCooldownMemory>(NodeMemory);
+	if (MyMemory->bHasCachedResult)
+	{
+		return MyMemory->bIsOnCooldown;
+	}
+
 	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
@@ -52,14 +73,105 @@ bool UKaosBTDecorator_IsAbilityOnCooldown::CalculateRawConditionValue(UBehaviorT
 		return false;
 	}
 
-	UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
 	if (!ASC)
 	{
 		return false;
 	}
 
-	float TimeRemaining, Duration; // Not used, but needed for the function
-	return UKaosUtilitiesBlueprintLibrary::IsAbilityOnCooldownWithAllTags(ASC, FGameplayTagContainer(AbilityTag), TimeRemaining, Duration);
+	return FKaosBTAbilitySystemQueryCache::IsAbilityWithTagOnCooldown(*ASC, AbilityTag);
+}
+
+void UKaosBTDecorator_IsAbilityOnCooldown::GatherCooldownTags(const UAbilitySystemComponent& AbilitySystemComponent, FGameplayTagContainer& OutCooldownTags) const
+{
+	for (const FGameplayAbilitySpec& Spec : AbilitySystemComponent.GetActivatableAbilities())
+	{
+		if (Spec.Ability == nullptr || !Spec.Ability->GetAssetTags().HasTag(AbilityTag))
+		{
+			continue;
+		}
+
+		if (const FGameplayTagContainer* CooldownTags = Spec.Ability->GetCooldownTags())
+		{
+			OutCooldownTags.AppendTags(*CooldownTags);
+		}
+	}
+}
+
+void UKaosBTDecorator_IsAbilityOnCooldown::OnCooldownTagChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory)
+{
+	FKaosBTDecorator_IsAbilityOnCooldownMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsAbilityOnCooldownMemory>(NodeMemory);
+	const UAbilitySystemComponent* ASC = MyMemory->CachedAbilitySystemComponent.Get();
+	if (!ASC)
+	{
+		return;
+	}
+
+	// Another cooldown tag may still be present
+	const bool bIsOnCooldown = ASC->HasAnyMatchingGameplayTags(MyMemory->CooldownTags);
+	if (bIsOnCooldown == MyMemory->bIsOnCooldown)
+	{
+		return;
+	}
+	MyMemory->bIsOnCooldown = bIsOnCooldown;
+
+	if (!BehaviorTreeComponent.IsValid())
+	{
+		return;
+	}
+
+	ConditionalFlowAbort(*BehaviorTreeComponent, EBTDecoratorAbortRequest::ConditionResultChanged);
+}
+
+void UKaosBTDecorator_IsAbilityOnCooldown::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	if (!BlackboardComp)
+	{
+		// Not calling super here since it does nothing
+		return;
+	}
+
+	const AActor* SelectedActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(TargetActorKey.GetSelectedKeyID()));
+	UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
+	if (!ASC)
+	{
+		// Not calling super here since it does nothing
+		return;
+	}
+
+	FKaosBTDecorator_IsAbilityOnCooldownMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsAbilityOnCooldownMemory>(NodeMemory);
+	MyMemory->CachedAbilitySystemComponent = ASC;
+	MyMemory->CooldownTags.Reset();
+	GatherCooldownTags(*ASC, MyMemory->CooldownTags);
+
+	for (const FGameplayTag& CooldownTag : MyMemory->CooldownTags)
+	{
+		FDelegateHandle GameplayTagEventCallbackDelegate = ASC->RegisterGameplayTagEvent(CooldownTag, EGameplayTagEventType::NewOrRemoved).AddUObject(
+			this, &UKaosBTDecorator_IsAbilityOnCooldown::OnCooldownTagChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory);
+		MyMemory->GameplayTagEventHandles.Emplace(CooldownTag, GameplayTagEventCallbackDelegate);
+	}
+
+	MyMemory->bIsOnCooldown = ASC->HasAnyMatchingGameplayTags(MyMemory->CooldownTags);
+	MyMemory->bHasCachedResult = true;
+}
+
+void UKaosBTDecorator_IsAbilityOnCooldown::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FKaosBTDecorator_IsAbilityOnCooldownMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsAbilityOnCooldownMemory>(NodeMemory);
+
+	if (UAbilitySystemComponent* ASC = MyMemory->CachedAbilitySystemComponent.Get())
+	{
+		for (const TTuple<FGameplayTag, FDelegateHandle>& GameplayTagEvent : MyMemory->GameplayTagEventHandles)
+		{
+			ASC->RegisterGameplayTagEvent(GameplayTagEvent.Key, EGameplayTagEventType::NewOrRemoved).Remove(GameplayTagEvent.Value);
+		}
+	}
+
+	MyMemory->GameplayTagEventHandles.Reset();
+	MyMemory->CooldownTags.Reset();
+	MyMemory->CachedAbilitySystemComponent = nullptr;
+	MyMemory->bHasCachedResult = false;
 }
 
 FString UKaosBTDecorator_IsAbilityOnCooldown::GetStaticDescription() const
@@ -77,3 +189,18 @@ void UKaosBTDecorator_IsAbilityOnCooldown::InitializeFromAsset(UBehaviorTree& As
 		TargetActorKey.ResolveSelectedKey(*BBAsset);
 	}
 }
+
+uint16 UKaosBTDecorator_IsAbilityOnCooldown::GetInstanceMemorySize() const
+{
+	return sizeof(FKaosBTDecorator_IsAbilityOnCooldownMemory);
+}
+
+void UKaosBTDecorator_IsAbilityOnCooldown::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTDecorator_IsAbilityOnCooldownMemory>(NodeMemory, InitType);
+}
+
+void UKaosBTDecorator_IsAbilityOnCooldown::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FKaosBTDecorator_IsAbilityOnCooldownMemory>(NodeMemory, CleanupType);
+}
@@ -21,6 +21,14 @@
 #include "BehaviourTrees/KaosBTDecorator_IsInRange.h"
 
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviourTrees/KaosRangeCheckSubsystem.h"
+
+struct FKaosBTDecorator_IsInRangeMemory
+{
+	/** Range check registered while the decorator is relevant */
+	FKaosRangeCheckHandle RangeCheckHandle;
+};
 
 UKaosBTDecorator_IsInRange::UKaosBTDecorator_IsInRange()
 {
@@ -36,16 +44,21 @@ UKaosBTDecorator_IsInRange::UKaosBTDecorator_IsInRange()
 	TargetActorKey.SelectedKeyName = FBlackboard::KeySelf;
 }
 
-void UKaosBTDecorator_IsInRange::PostLoad()
+uint16 UKaosBTDecorator_IsInRange::GetInstanceMemorySize() const
 {
-	Super::PostLoad();
+	return sizeof(FKaosBTDecorator_IsInRangeMemory);
+}
 
-	bNotifyTick = (FlowAbortMode != EBTFlowAbortMode::None);
+void UKaosBTDecorator_IsInRange::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory, InitType);
 }
 
-uint16 UKaosBTDecorator_IsInRange::GetInstanceMemorySize() const
+void UKaosBTDecorator_IsInRange::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
 {
-	return Super::GetInstanceMemorySize();
+	const FKaosBTDecorator_IsInRangeMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory);
+	ensureMsgf(!MyMemory->RangeCheckHandle.IsValid(), TEXT("Dangling range check for decorator %s"), *GetStaticDescription());
+	CleanupNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory, CleanupType);
 }
 
 FString UKaosBTDecorator_IsInRange::GetStaticDescription() const
@@ -55,46 +68,129 @@ FString UKaosBTDecorator_IsInRange::GetStaticDescription() const
 
 bool UKaosBTDecorator_IsInRange::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	const FKaosBTDecorator_IsInRangeMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory);
+	if (MyMemory->RangeCheckHandle.IsValid())
+	{
+		if (const UKaosRangeCheckSubsystem* RangeCheckSubsystem = UKaosRangeCheckSubsystem::Get(OwnerComp.GetWorld()))
+		{
+			return RangeCheckSubsystem->IsInRange(MyMemory->RangeCheckHandle);
+		}
+	}
 	return InternalCalculateRawConditionValue(OwnerComp, NodeMemory);
 }
 
 bool UKaosBTDecorator_IsInRange::InternalCalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
 	const UBlackboardComponent* MyBlackboard = OwnerComp.GetBlackboardComponent();
+	if (!MyBlackboard)
+	{
+		return false;
+	}
 
-	const AActor* const SourceActor = Cast<AActor>(MyBlackboard->GetValueAsObject(SourceActorKey.SelectedKeyName));
-	const AActor* const TargetActor = Cast<AActor>(MyBlackboard->GetValueAsObject(TargetActorKey.SelectedKeyName));
+	const AActor* const SourceActor = Cast<AActor>(MyBlackboard->GetValue<UBlackboardKeyType_Object>(SourceActorKey.GetSelectedKeyID()));
+	const AActor* const TargetActor = Cast<AActor>(MyBlackboard->GetValue<UBlackboardKeyType_Object>(TargetActorKey.GetSelectedKeyID()));
 
 	if (SourceActor && TargetActor)
 	{
+		// The raw value, the behaviour tree applies IsInversed() itself
 		const float RangeSq = FMath::Square(Range);
 		const float DistanceSq = FVector::DistSquared(SourceActor->GetActorLocation(), TargetActor->GetActorLocation());
-		return IsInversed() ? DistanceSq >= RangeSq : DistanceSq <= RangeSq;
+		return DistanceSq <= RangeSq;
 	}
 	return false;
 }
 
-void UKaosBTDecorator_IsInRange::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+void UKaosBTDecorator_IsInRange::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	// Without an abort mode nothing needs to watch the range
+	if (FlowAbortMode == EBTFlowAbortMode::None)
+	{
+		return;
+	}
+
+	UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	UKaosRangeCheckSubsystem* RangeCheckSubsystem = UKaosRangeCheckSubsystem::Get(OwnerComp.GetWorld());
+	if (!BlackboardComp || !RangeCheckSubsystem)
+	{
+		return;
+	}
+
+	const AActor* SourceActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(SourceActorKey.GetSelectedKeyID()));
+	const AActor* TargetActor = Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(TargetActorKey.GetSelectedKeyID()));
+
+	FKaosBTDecorator_IsInRangeMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory);
+	MyMemory->RangeCheckHandle = RangeCheckSubsystem->RegisterRangeCheck(SourceActor, TargetActor, Range, Hysteresis,
+		FKaosOnRangeCheckChanged::CreateUObject(this, &UKaosBTDecorator_IsInRange::OnRangeChanged, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp)), MaxStaleness);
+
+	BlackboardComp->RegisterObserver(SourceActorKey.GetSelectedKeyID(), this, FOnBlackboardChangeNotification::CreateUObject(this, &UKaosBTDecorator_IsInRange::OnBlackboardKeyValueChange));
+	if (TargetActorKey.GetSelectedKeyID() != SourceActorKey.GetSelectedKeyID())
+	{
+		BlackboardComp->RegisterObserver(TargetActorKey.GetSelectedKeyID(), this, FOnBlackboardChangeNotification::CreateUObject(this, &UKaosBTDecorator_IsInRange::OnBlackboardKeyValueChange));
+	}
+}
+
+void UKaosBTDecorator_IsInRange::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	if (GetShouldAbort(OwnerComp, NodeMemory))
+	FKaosBTDecorator_IsInRangeMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory);
+	if (!MyMemory->RangeCheckHandle.IsValid())
+	{
+		return;
+	}
+
+	if (UKaosRangeCheckSubsystem* RangeCheckSubsystem = UKaosRangeCheckSubsystem::Get(OwnerComp.GetWorld()))
 	{
-		OwnerComp.RequestExecution(this);
+		RangeCheckSubsystem->UnregisterRangeCheck(MyMemory->RangeCheckHandle);
+	}
+	MyMemory->RangeCheckHandle.Reset();
+
+	if (UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent())
+	{
+		BlackboardComp->UnregisterObserversFrom(this);
 	}
 }
 
-bool UKaosBTDecorator_IsInRange::GetShouldAbort(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
+void UKaosBTDecorator_IsInRange::OnRangeChanged(bool bInRange, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent)
 {
-	const bool bIsOnActiveBranch = OwnerComp.IsExecutingBranch(GetMyNode(), GetChildIndex());
+	if (!BehaviorTreeComponent.IsValid())
+	{
+		return;
+	}
 
-	bool bShouldAbort;
-	if (bIsOnActiveBranch)
+	ConditionalFlowAbort(*BehaviorTreeComponent, EBTDecoratorAbortRequest::ConditionResultChanged);
+}
+
+EBlackboardNotificationResult UKaosBTDecorator_IsInRange::OnBlackboardKeyValueChange(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKeyID)
+{
+	UBehaviorTreeComponent* BehaviorComp = Cast<UBehaviorTreeComponent>(Blackboard.GetBrainComponent());
+	if (!BehaviorComp)
 	{
-		bShouldAbort = (FlowAbortMode == EBTFlowAbortMode::Self || FlowAbortMode == EBTFlowAbortMode::Both) && InternalCalculateRawConditionValue(OwnerComp, NodeMemory) == IsInversed();
+		return EBlackboardNotificationResult::RemoveObserver;
 	}
-	else
+
+	uint8* NodeMemory = BehaviorComp->GetNodeMemory(this, BehaviorComp->FindInstanceContainingNode(this));
+	UKaosRangeCheckSubsystem* RangeCheckSubsystem = UKaosRangeCheckSubsystem::Get(BehaviorComp->GetWorld());
+	if (!NodeMemory || !RangeCheckSubsystem)
 	{
-		bShouldAbort = (FlowAbortMode == EBTFlowAbortMode::LowerPriority || FlowAbortMode == EBTFlowAbortMode::Both) && InternalCalculateRawConditionValue(OwnerComp, NodeMemory) != IsInversed();
+		return EBlackboardNotificationResult::RemoveObserver;
 	}
 
-	return bShouldAbort;
+	// Fires the range changed delegate, and with it the abort, if the new pair crossed the range
+	const FKaosBTDecorator_IsInRangeMemory* MyMemory = CastInstanceNodeMemory<FKaosBTDecorator_IsInRangeMemory>(NodeMemory);
+	RangeCheckSubsystem->SetRangeCheckActors(MyMemory->RangeCheckHandle,
+		Cast<AActor>(Blackboard.GetValue<UBlackboardKeyType_Object>(SourceActorKey.GetSelectedKeyID())),
+		Cast<AActor>(Blackboard.GetValue<UBlackboardKeyType_Object>(TargetActorKey.GetSelectedKeyID())));
+
+	return EBlackboardNotificationResult::ContinueObserving;
+}
+
+void UKaosBTDecorator_IsInRange::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	const UBlackboardData* BBAsset = GetBlackboardAsset();
+	if (ensure(BBAsset))
+	{
+		SourceActorKey.ResolveSelectedKey(*BBAsset);
+		TargetActorKey.ResolveSelectedKey(*BBAsset);
+	}
 }
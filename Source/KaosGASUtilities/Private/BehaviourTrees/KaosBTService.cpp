@@ -0,0 +1,96 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "BehaviourTrees/KaosBTService.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(KaosBTService)
+
+UKaosBTService::UKaosBTService()
+{
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+}
+
+void UKaosBTService::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	// The scheduler runs the ticks instead
+	if (bUseTickScheduler)
+	{
+		bNotifyTick = false;
+	}
+}
+
+void UKaosBTService::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	if (!bUseTickScheduler)
+	{
+		return;
+	}
+
+	if (UKaosBTTickSchedulerSubsystem* TickScheduler = UKaosBTTickSchedulerSubsystem::Get(OwnerComp.GetWorld()))
+	{
+		FKaosBTServiceMemory* MyMemory = CastInstanceNodeMemory<FKaosBTServiceMemory>(NodeMemory);
+		MyMemory->TickSchedulerHandle = TickScheduler->RegisterEvaluation(OwnerComp, Interval, RandomDeviation,
+			FKaosScheduledBTTick::CreateUObject(this, &UKaosBTService::OnScheduledTick, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory));
+	}
+}
+
+void UKaosBTService::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+
+	FKaosBTServiceMemory* MyMemory = CastInstanceNodeMemory<FKaosBTServiceMemory>(NodeMemory);
+	if (MyMemory->TickSchedulerHandle.IsValid())
+	{
+		if (UKaosBTTickSchedulerSubsystem* TickScheduler = UKaosBTTickSchedulerSubsystem::Get(OwnerComp.GetWorld()))
+		{
+			TickScheduler->UnregisterEvaluation(MyMemory->TickSchedulerHandle);
+		}
+		MyMemory->TickSchedulerHandle.Reset();
+	}
+}
+
+uint16 UKaosBTService::GetInstanceMemorySize() const
+{
+	return sizeof(FKaosBTServiceMemory);
+}
+
+void UKaosBTService::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTServiceMemory>(NodeMemory, InitType);
+}
+
+void UKaosBTService::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FKaosBTServiceMemory>(NodeMemory, CleanupType);
+}
+
+void UKaosBTService::OnScheduledTick(float DeltaSeconds, TWeakObjectPtr<UBehaviorTreeComponent> OwnerComp, uint8* NodeMemory)
+{
+	if (UBehaviorTreeComponent* BTComp = OwnerComp.Get())
+	{
+		TickNode(*BTComp, NodeMemory, DeltaSeconds);
+	}
+}
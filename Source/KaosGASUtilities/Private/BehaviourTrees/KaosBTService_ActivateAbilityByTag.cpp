@@ -20,15 +20,40 @@
 
 #include "BehaviourTrees/KaosBTService_ActivateAbilityByTag.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
+#include "Abilities/GameplayAbility.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
 #include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
 
+struct FKaosBTService_ActivateAbilityByTagMemory : public FKaosBTServiceMemory
+{
+	TWeakObjectPtr<UAbilitySystemComponent> CachedAbilitySystemComponent;
+
+	/** Target blackboard value the ASC was resolved from, a different value resolves it again */
+	TWeakObjectPtr<const AActor> CachedTargetActor;
+
+	/** Specs matching AbilityToActivate, resolved on the first event driven attempt */
+	TArray<FGameplayAbilitySpecHandle> AbilitySpecHandles;
+
+	FDelegateHandle AbilityEndedHandle;
+	FDelegateHandle GameplayTagChangedHandle;
+	FDelegateHandle AbilityBlockTagsChangedHandle;
+	FDelegateHandle AbilityGrantedHandle;
+	FDelegateHandle AbilityRemovedHandle;
+
+	double LastActivationAttemptTime = 0.0;
+
+	/** Set by events that can make activation succeed, starts set so the first tick tries */
+	bool bActivationConditionsChanged = true;
+};
+
 UKaosBTService_ActivateAbilityByTag::UKaosBTService_ActivateAbilityByTag()
 {
 	NodeName = "Kaos Activate Ability With GameplayTag";
 	bNotifyTick = true;
+	bNotifyBecomeRelevant = true;
 	bNotifyCeaseRelevant = true;
 
 	// Accept only actors
@@ -42,6 +67,12 @@ void UKaosBTService_ActivateAbilityByTag::TickNode(UBehaviorTreeComponent& Owner
 {
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
 
+	if (bEventDriven)
+	{
+		TickEventDriven(OwnerComp, NodeMemory);
+		return;
+	}
+
 	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 	if (!BlackboardComp)
 	{
@@ -54,19 +85,19 @@ void UKaosBTService_ActivateAbilityByTag::TickNode(UBehaviorTreeComponent& Owner
 		return;
 	}
 
-	UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
 	if (!ASC)
 	{
 		return;
 	}
 
-	if (UKaosUtilitiesBlueprintLibrary::HasActiveAbilityWithMatchingTags(ASC, FGameplayTagContainer(AbilityToActivate)))
+	if (FKaosBTAbilitySystemQueryCache::IsAbilityWithTagActive(*ASC, AbilityToActivate))
 	{
 		//Do nothing as the ability is active
 		return;
 	}
 
-	if (!UKaosUtilitiesBlueprintLibrary::CanActivateAbilityWithMatchingTags(ASC, FGameplayTagContainer(AbilityToActivate)))
+	if (!FKaosBTAbilitySystemQueryCache::CanActivateAbilityWithTag(*ASC, AbilityToActivate))
 	{
 		//Do nothing if we can not activate the ability
 		return;
@@ -76,9 +107,179 @@ void UKaosBTService_ActivateAbilityByTag::TickNode(UBehaviorTreeComponent& Owner
 	ASC->TryActivateAbilitiesByTag(FGameplayTagContainer(AbilityToActivate));
 }
 
+void UKaosBTService_ActivateAbilityByTag::TickEventDriven(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FKaosBTService_ActivateAbilityByTagMemory& MyMemory = *CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory);
+
+	// The target may not have had an ASC yet when the service became relevant, or the key may point at another actor since
+	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	const AActor* SelectedActor = BlackboardComp ? Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(TargetBlackboardKey.GetSelectedKeyID())) : nullptr;
+	if (!MyMemory.CachedAbilitySystemComponent.IsValid() || MyMemory.CachedTargetActor.Get() != SelectedActor)
+	{
+		UnbindActivationEvents(MyMemory);
+		MyMemory.CachedTargetActor = SelectedActor;
+		MyMemory.AbilitySpecHandles.Reset();
+		MyMemory.bActivationConditionsChanged = true;
+		if (UAbilitySystemComponent* NewASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor))
+		{
+			BindActivationEvents(*NewASC, NodeMemory);
+		}
+	}
+
+	UAbilitySystemComponent* ASC = MyMemory.CachedAbilitySystemComponent.Get();
+	if (!ASC)
+	{
+		return;
+	}
+
+	const double CurrentTime = OwnerComp.GetWorld()->GetTimeSeconds();
+	const bool bRetryIntervalElapsed = EventDrivenRetryInterval > 0.f && CurrentTime - MyMemory.LastActivationAttemptTime >= EventDrivenRetryInterval;
+	if (!MyMemory.bActivationConditionsChanged && !bRetryIntervalElapsed)
+	{
+		return;
+	}
+
+	MyMemory.bActivationConditionsChanged = false;
+	MyMemory.LastActivationAttemptTime = CurrentTime;
+
+	if (MyMemory.AbilitySpecHandles.IsEmpty())
+	{
+		CacheAbilitySpecHandles(*ASC, MyMemory);
+	}
+
+	int32 NumFoundSpecs = 0;
+	for (const FGameplayAbilitySpecHandle& Handle : MyMemory.AbilitySpecHandles)
+	{
+		if (const FGameplayAbilitySpec* Spec = ASC->FindAbilitySpecFromHandle(Handle))
+		{
+			if (Spec->IsActive())
+			{
+				//Do nothing as the ability is active, it ending will raise an event
+				return;
+			}
+			++NumFoundSpecs;
+		}
+	}
+
+	if (NumFoundSpecs == 0)
+	{
+		// The abilities were removed, resolve them again on the next attempt
+		MyMemory.AbilitySpecHandles.Reset();
+		return;
+	}
+
+	//Activate the ability, TryActivateAbility checks whether it can be activated
+	for (const FGameplayAbilitySpecHandle& Handle : MyMemory.AbilitySpecHandles)
+	{
+		ASC->TryActivateAbility(Handle);
+	}
+}
+
+void UKaosBTService_ActivateAbilityByTag::CacheAbilitySpecHandles(UAbilitySystemComponent& AbilitySystemComponent, FKaosBTService_ActivateAbilityByTagMemory& MyMemory) const
+{
+	TArray<FGameplayAbilitySpec*> MatchingSpecs;
+	AbilitySystemComponent.GetActivatableGameplayAbilitySpecsByAllMatchingTags(FGameplayTagContainer(AbilityToActivate), MatchingSpecs, false);
+
+	MyMemory.AbilitySpecHandles.Reset(MatchingSpecs.Num());
+	for (const FGameplayAbilitySpec* Spec : MatchingSpecs)
+	{
+		MyMemory.AbilitySpecHandles.Add(Spec->Handle);
+	}
+}
+
+void UKaosBTService_ActivateAbilityByTag::BindActivationEvents(UAbilitySystemComponent& AbilitySystemComponent, uint8* NodeMemory)
+{
+	FKaosBTService_ActivateAbilityByTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory);
+	MyMemory->CachedAbilitySystemComponent = &AbilitySystemComponent;
+
+	// Ending abilities free up blocked, cancelled and cooldown gated activations, tag changes cover required, blocked and cooldown tags
+	MyMemory->AbilityEndedHandle = AbilitySystemComponent.AbilityEndedCallbacks.AddUObject(this, &UKaosBTService_ActivateAbilityByTag::OnAbilityEnded, NodeMemory);
+	MyMemory->GameplayTagChangedHandle = AbilitySystemComponent.RegisterGenericGameplayTagEvent().AddUObject(this, &UKaosBTService_ActivateAbilityByTag::OnGameplayTagChanged, NodeMemory);
+	if (UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(&AbilitySystemComponent))
+	{
+		MyMemory->AbilityBlockTagsChangedHandle = KaosASC->OnAbilityBlockTagsChanged.AddUObject(this, &UKaosBTService_ActivateAbilityByTag::OnAbilityBlockTagsChanged, NodeMemory);
+
+		// Abilities granted after the tree started, or removed from under the cached handles
+		MyMemory->AbilityGrantedHandle = KaosASC->OnAbilityGranted.AddUObject(this, &UKaosBTService_ActivateAbilityByTag::OnAbilitySpecChanged, NodeMemory);
+		MyMemory->AbilityRemovedHandle = KaosASC->OnAbilityRemoved.AddUObject(this, &UKaosBTService_ActivateAbilityByTag::OnAbilitySpecChanged, NodeMemory);
+	}
+}
+
+void UKaosBTService_ActivateAbilityByTag::UnbindActivationEvents(FKaosBTService_ActivateAbilityByTagMemory& MyMemory) const
+{
+	if (UAbilitySystemComponent* CachedASC = MyMemory.CachedAbilitySystemComponent.Get())
+	{
+		CachedASC->AbilityEndedCallbacks.Remove(MyMemory.AbilityEndedHandle);
+		CachedASC->RegisterGenericGameplayTagEvent().Remove(MyMemory.GameplayTagChangedHandle);
+		if (UKaosAbilitySystemComponent* KaosASC = Cast<UKaosAbilitySystemComponent>(CachedASC))
+		{
+			KaosASC->OnAbilityBlockTagsChanged.Remove(MyMemory.AbilityBlockTagsChangedHandle);
+			KaosASC->OnAbilityGranted.Remove(MyMemory.AbilityGrantedHandle);
+			KaosASC->OnAbilityRemoved.Remove(MyMemory.AbilityRemovedHandle);
+		}
+	}
+	MyMemory.AbilityEndedHandle.Reset();
+	MyMemory.GameplayTagChangedHandle.Reset();
+	MyMemory.AbilityBlockTagsChangedHandle.Reset();
+	MyMemory.AbilityGrantedHandle.Reset();
+	MyMemory.AbilityRemovedHandle.Reset();
+	MyMemory.CachedAbilitySystemComponent = nullptr;
+}
+
+void UKaosBTService_ActivateAbilityByTag::OnAbilityEnded(UGameplayAbility* Ability, uint8* NodeMemory)
+{
+	CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory)->bActivationConditionsChanged = true;
+}
+
+void UKaosBTService_ActivateAbilityByTag::OnGameplayTagChanged(const FGameplayTag InTag, int32 NewCount, uint8* NodeMemory)
+{
+	CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory)->bActivationConditionsChanged = true;
+}
+
+void UKaosBTService_ActivateAbilityByTag::OnAbilityBlockTagsChanged(uint8* NodeMemory)
+{
+	CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory)->bActivationConditionsChanged = true;
+}
+
+void UKaosBTService_ActivateAbilityByTag::OnAbilitySpecChanged(const FGameplayAbilitySpec& AbilitySpec, uint8* NodeMemory)
+{
+	if (AbilitySpec.Ability && AbilitySpec.Ability->GetAssetTags().HasTag(AbilityToActivate))
+	{
+		FKaosBTService_ActivateAbilityByTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory);
+		MyMemory->AbilitySpecHandles.Reset();
+		MyMemory->bActivationConditionsChanged = true;
+	}
+}
+
+void UKaosBTService_ActivateAbilityByTag::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FKaosBTService_ActivateAbilityByTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory);
+	MyMemory->bActivationConditionsChanged = true;
+	MyMemory->AbilitySpecHandles.Reset();
+
+	if (bEventDriven)
+	{
+		const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+		const AActor* SelectedActor = BlackboardComp ? Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(TargetBlackboardKey.GetSelectedKeyID())) : nullptr;
+		MyMemory->CachedTargetActor = SelectedActor;
+		if (UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor))
+		{
+			BindActivationEvents(*ASC, NodeMemory);
+		}
+	}
+
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+}
+
 void UKaosBTService_ActivateAbilityByTag::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
 	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+
+	FKaosBTService_ActivateAbilityByTagMemory* MyMemory = CastInstanceNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory);
+	UnbindActivationEvents(*MyMemory);
+	MyMemory->CachedTargetActor = nullptr;
+	MyMemory->AbilitySpecHandles.Reset();
+
 	if (NodeCeaseRelevanceBehaviour == EKaosActivateAbilityByTagOnCeaseRelevanceBehaviour::CancelAbility)
 	{
 		const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
@@ -93,7 +294,7 @@ void UKaosBTService_ActivateAbilityByTag::OnCeaseRelevant(UBehaviorTreeComponent
 			return;
 		}
 
-		UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+		UAbilitySystemComponent* ASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
 		if (!ASC)
 		{
 			return;
@@ -105,6 +306,22 @@ void UKaosBTService_ActivateAbilityByTag::OnCeaseRelevant(UBehaviorTreeComponent
 
 FString UKaosBTService_ActivateAbilityByTag::GetStaticDescription() const
 {
-	return FString::Printf(TEXT("%s: AbilityTag: %s\nCease Releavance: %s"), *Super::GetStaticDescription(), *AbilityToActivate.ToString(),
-	                       *StaticEnum<EKaosActivateAbilityByTagOnCeaseRelevanceBehaviour>()->GetNameStringByValue(static_cast<int64>(NodeCeaseRelevanceBehaviour)));
+	return FString::Printf(TEXT("%s: AbilityTag: %s\nCease Releavance: %s%s%s"), *Super::GetStaticDescription(), *AbilityToActivate.ToString(),
+	                       *StaticEnum<EKaosActivateAbilityByTagOnCeaseRelevanceBehaviour>()->GetNameStringByValue(static_cast<int64>(NodeCeaseRelevanceBehaviour)),
+	                       bEventDriven ? TEXT("\nEvent Driven") : TEXT(""), bUseTickScheduler ? TEXT("\nTick Scheduled") : TEXT(""));
+}
+
+uint16 UKaosBTService_ActivateAbilityByTag::GetInstanceMemorySize() const
+{
+	return sizeof(FKaosBTService_ActivateAbilityByTagMemory);
+}
+
+void UKaosBTService_ActivateAbilityByTag::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory, InitType);
+}
+
+void UKaosBTService_ActivateAbilityByTag::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FKaosBTService_ActivateAbilityByTagMemory>(NodeMemory, CleanupType);
 }
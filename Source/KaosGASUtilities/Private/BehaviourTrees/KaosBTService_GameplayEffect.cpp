@@ -21,11 +21,27 @@
 #include "BehaviourTrees/KaosBTService_GameplayEffect.h"
 
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
 #include "AIController.h"
 #include "GameplayEffect.h"
-#include "GameplayTagAssetInterface.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
+
+struct FKaosBTService_GameplayEffectMemory
+{
+	struct FCachedSpec
+	{
+		TSubclassOf<UGameplayEffect> GameplayEffect;
+		float Level = 1.f;
+		FGameplayEffectSpecHandle SpecHandle;
+	};
+
+	/** Owner component the cached specs were made by, they are rebuilt if the owner's component changes */
+	TWeakObjectPtr<UAbilitySystemComponent> SourceAbilitySystemComponent;
+
+	/** Outgoing specs of the activation and deactivation effects, built on their first application */
+	TArray<FCachedSpec, TInlineAllocator<2>> CachedSpecs;
+};
 
 UKaosBTService_GameplayEffect::UKaosBTService_GameplayEffect()
 {
@@ -61,7 +77,7 @@ void UKaosBTService_GameplayEffect::OnBecomeRelevant(UBehaviorTreeComponent& Own
 	case EKaosBTServiceGameplayEffectBehaviour::None:
 		break;
 	case EKaosBTServiceGameplayEffectBehaviour::Apply:
-		ApplyGameplayEffect(OwnerComp, false);
+		ApplyGameplayEffect(OwnerComp, NodeMemory, false);
 		break;
 	case EKaosBTServiceGameplayEffectBehaviour::Remove:
 		RemoveGameplayEffect(OwnerComp, false);
@@ -77,7 +93,7 @@ void UKaosBTService_GameplayEffect::OnCeaseRelevant(UBehaviorTreeComponent& Owne
 	case EKaosBTServiceGameplayEffectBehaviour::None:
 		break;
 	case EKaosBTServiceGameplayEffectBehaviour::Apply:
-		ApplyGameplayEffect(OwnerComp, true);
+		ApplyGameplayEffect(OwnerComp, NodeMemory, true);
 		break;
 	case EKaosBTServiceGameplayEffectBehaviour::Remove:
 		RemoveGameplayEffect(OwnerComp, true);
@@ -102,20 +118,37 @@ FString UKaosBTService_GameplayEffect::GetStaticDescription() const
 	return FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(), *TagDesc);;
 }
 
-void UKaosBTService_GameplayEffect::ApplyGameplayEffect(UBehaviorTreeComponent& OwnerComp, bool bFromDeactivation)
+uint16 UKaosBTService_GameplayEffect::GetInstanceMemorySize() const
+{
+	return sizeof(FKaosBTService_GameplayEffectMemory);
+}
+
+void UKaosBTService_GameplayEffect::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FKaosBTService_GameplayEffectMemory>(NodeMemory, InitType);
+}
+
+void UKaosBTService_GameplayEffect::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FKaosBTService_GameplayEffectMemory>(NodeMemory, CleanupType);
+}
+
+void UKaosBTService_GameplayEffect::ApplyGameplayEffect(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, bool bFromDeactivation)
 {
 	const TSubclassOf<UGameplayEffect> ChosenGE = bFromDeactivation ? DeactivationGameplayEffect : ActivationGameplayEffect;
+	const float ChosenLevel = bFromDeactivation ? DeactivationEffectLevel : ActivationEffectLevel;
 	const FGameplayTagQuery& ChosenOwnerQuery = bFromDeactivation ? DeactivationOwnerTagQuery : ActivationOwnerTagQuery;
 	const FBlackboardKeySelector& ChosenEffectBlackboardKey = bFromDeactivation ? DeactivationEffectTargetBlackboardKey : ActivationEffectTargetBlackboardKey;
-	const FGameplayTagQuery ChosenBlackboardKeyTagQuery = bFromDeactivation ? DeactivationEffectTargetTagQuery : ActivationEffectTargetTagQuery;
+	const FGameplayTagQuery& ChosenBlackboardKeyTagQuery = bFromDeactivation ? DeactivationEffectTargetTagQuery : ActivationEffectTargetTagQuery;
 
 	//No GE? Do nothing.
-	if (ChosenGE)
+	if (!ChosenGE)
 	{
 		return;
 	}
 
-	UAbilitySystemComponent* OwnerASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(OwnerComp.GetAIOwner()->GetPawn());
+	const AAIController* AIOwner = OwnerComp.GetAIOwner();
+	UAbilitySystemComponent* OwnerASC = AIOwner ? FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(AIOwner->GetPawn()) : nullptr;
 
 	//No owner ASC? Do nothing.
 	if (!OwnerASC)
@@ -124,13 +157,14 @@ void UKaosBTService_GameplayEffect::ApplyGameplayEffect(UBehaviorTreeComponent&
 	}
 
 	//Owner tag query failed? We do nothing.
-	if (!CheckGameplayTagQuery(OwnerASC, ChosenOwnerQuery))
+	if (!CheckGameplayTagQuery(*OwnerASC, ChosenOwnerQuery))
 	{
 		return;
 	}
 
-	const AActor* TargetActor = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValueAsObject(ChosenEffectBlackboardKey.SelectedKeyName));
-	UAbilitySystemComponent* TargetASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(TargetActor);
+	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	const AActor* TargetActor = BlackboardComp ? Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ChosenEffectBlackboardKey.GetSelectedKeyID())) : nullptr;
+	UAbilitySystemComponent* TargetASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(TargetActor);
 
 	// No target ASC, do nothing.
 	if (!TargetASC)
@@ -139,13 +173,41 @@ void UKaosBTService_GameplayEffect::ApplyGameplayEffect(UBehaviorTreeComponent&
 	}
 
 	//Target tag query failed? We do nothing.
-	if (!CheckGameplayTagQuery(TargetASC, ChosenBlackboardKeyTagQuery))
+	if (!CheckGameplayTagQuery(*TargetASC, ChosenBlackboardKeyTagQuery))
 	{
 		return;
 	}
 
-	UGameplayEffect* GameplayEffectCDO = ChosenGE->GetDefaultObject<UGameplayEffect>();
-	OwnerASC->ApplyGameplayEffectToTarget(GameplayEffectCDO, TargetASC, 1, TargetASC->MakeEffectContext());
+	const FGameplayEffectSpecHandle SpecHandle = FindOrMakeOutgoingSpec(*OwnerASC, *CastInstanceNodeMemory<FKaosBTService_GameplayEffectMemory>(NodeMemory), ChosenGE, ChosenLevel);
+	if (SpecHandle.IsValid())
+	{
+		OwnerASC->ApplyGameplayEffectSpecToTarget(*SpecHandle.Data.Get(), TargetASC);
+	}
+}
+
+FGameplayEffectSpecHandle UKaosBTService_GameplayEffect::FindOrMakeOutgoingSpec(UAbilitySystemComponent& OwnerASC, FKaosBTService_GameplayEffectMemory& MyMemory, TSubclassOf<UGameplayEffect> GameplayEffect, float Level) const
+{
+	if (MyMemory.SourceAbilitySystemComponent != &OwnerASC)
+	{
+		MyMemory.SourceAbilitySystemComponent = &OwnerASC;
+		MyMemory.CachedSpecs.Reset();
+	}
+
+	for (const FKaosBTService_GameplayEffectMemory::FCachedSpec& CachedSpec : MyMemory.CachedSpecs)
+	{
+		if (CachedSpec.GameplayEffect == GameplayEffect && CachedSpec.Level == Level && CachedSpec.SpecHandle.IsValid())
+		{
+			// Applying copies the spec, so the cached one only needs the owner's current tags and snapshotted attributes
+			CachedSpec.SpecHandle.Data->CaptureDataFromSource();
+			return CachedSpec.SpecHandle;
+		}
+	}
+
+	FKaosBTService_GameplayEffectMemory::FCachedSpec& CachedSpec = MyMemory.CachedSpecs.AddDefaulted_GetRef();
+	CachedSpec.GameplayEffect = GameplayEffect;
+	CachedSpec.Level = Level;
+	CachedSpec.SpecHandle = OwnerASC.MakeOutgoingSpec(GameplayEffect, Level, OwnerASC.MakeEffectContext());
+	return CachedSpec.SpecHandle;
 }
 
 void UKaosBTService_GameplayEffect::RemoveGameplayEffect(UBehaviorTreeComponent& OwnerComp, bool bFromDeactivation)
@@ -153,7 +215,7 @@ void UKaosBTService_GameplayEffect::RemoveGameplayEffect(UBehaviorTreeComponent&
 	const TSubclassOf<UGameplayEffect> ChosenGE = bFromDeactivation ? DeactivationGameplayEffect : ActivationGameplayEffect;
 	const FGameplayTagQuery& ChosenOwnerQuery = bFromDeactivation ? DeactivationOwnerTagQuery : ActivationOwnerTagQuery;
 	const FBlackboardKeySelector& ChosenEffectBlackboardKey = bFromDeactivation ? DeactivationEffectTargetBlackboardKey : ActivationEffectTargetBlackboardKey;
-	const FGameplayTagQuery ChosenBlackboardKeyTagQuery = bFromDeactivation ? DeactivationEffectTargetTagQuery : ActivationEffectTargetTagQuery;
+	const FGameplayTagQuery& ChosenBlackboardKeyTagQuery = bFromDeactivation ? DeactivationEffectTargetTagQuery : ActivationEffectTargetTagQuery;
 	const int32 StackCountToRemove = bFromDeactivation ? DeactivationEffectStacksToRemove : ActivationEffectStacksToRemove;
 
 	//No GE? can't do anything
@@ -162,23 +224,25 @@ void UKaosBTService_GameplayEffect::RemoveGameplayEffect(UBehaviorTreeComponent&
 		return;
 	}
 
-	UAbilitySystemComponent* OwnerASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(OwnerComp.GetAIOwner()->GetPawn());
+	const AAIController* AIOwner = OwnerComp.GetAIOwner();
+	UAbilitySystemComponent* OwnerASC = AIOwner ? FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(AIOwner->GetPawn()) : nullptr;
 	if (!OwnerASC)
 	{
 		return;
 	}
 
-	if (!CheckGameplayTagQuery(OwnerASC, ChosenOwnerQuery))
+	if (!CheckGameplayTagQuery(*OwnerASC, ChosenOwnerQuery))
 	{
 		return;
 	}
 
-	const AActor* TargetActor = Cast<AActor>(OwnerComp.GetBlackboardComponent()->GetValueAsObject(ChosenEffectBlackboardKey.SelectedKeyName));
-	UAbilitySystemComponent* TargetASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(TargetActor);
+	const UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	const AActor* TargetActor = BlackboardComp ? Cast<AActor>(BlackboardComp->GetValue<UBlackboardKeyType_Object>(ChosenEffectBlackboardKey.GetSelectedKeyID())) : nullptr;
+	UAbilitySystemComponent* TargetASC = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(TargetActor);
 
 	if (TargetASC)
 	{
-		if (!CheckGameplayTagQuery(TargetASC, ChosenBlackboardKeyTagQuery))
+		if (!CheckGameplayTagQuery(*TargetASC, ChosenBlackboardKeyTagQuery))
 		{
 			return;
 		}
@@ -187,20 +251,8 @@ void UKaosBTService_GameplayEffect::RemoveGameplayEffect(UBehaviorTreeComponent&
 	}
 }
 
-bool UKaosBTService_GameplayEffect::CheckGameplayTagQuery(UAbilitySystemComponent* ASC, const FGameplayTagQuery& Query)
+bool UKaosBTService_GameplayEffect::CheckGameplayTagQuery(const UAbilitySystemComponent& ASC, const FGameplayTagQuery& Query) const
 {
-	if (!Query.IsEmpty() && ASC)
-	{
-		const IGameplayTagAssetInterface* GameplayTagAssetInterface = Cast<IGameplayTagAssetInterface>(ASC);
-		if (GameplayTagAssetInterface)
-		{
-			FGameplayTagContainer Tags;
-			GameplayTagAssetInterface->GetOwnedGameplayTags(Tags);
-			if (Query.Matches(Tags))
-			{
-				return true;
-			}
-		}
-	}
-	return false;
+	// An empty query places no requirement, matched against the component's own tag container so nothing is copied
+	return Query.IsEmpty() || Query.Matches(ASC.GetOwnedGameplayTags());
 }
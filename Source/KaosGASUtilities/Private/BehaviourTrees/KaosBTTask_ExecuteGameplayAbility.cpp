@@ -20,7 +20,7 @@
 
 #include "BehaviourTrees/KaosBTTask_ExecuteGameplayAbility.h"
 #include "AbilitySystemComponent.h"
-#include "AbilitySystemGlobals.h"
+#include "BehaviourTrees/KaosBTAbilitySystemQueryCache.h"
 #include "GameplayAbilitySpec.h"
 #include "GameplayAbilitySpecHandle.h"
 #include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
@@ -72,7 +72,7 @@ EBTNodeResult::Type UKaosBTTask_ExecuteGameplayAbility::ExecuteTask(UBehaviorTre
 
 	FKaosBTTask_ExecuteGameplayAbilityMemory* MyMemory = CastInstanceNodeMemory<FKaosBTTask_ExecuteGameplayAbilityMemory>(NodeMemory);
 
-	MyMemory->CachedAbilitySystemComponent = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(SelectedActor);
+	MyMemory->CachedAbilitySystemComponent = FKaosBTAbilitySystemQueryCache::FindAbilitySystemComponent(SelectedActor);
 	if (!MyMemory->CachedAbilitySystemComponent.IsValid())
 	{
 		return EBTNodeResult::Failed;
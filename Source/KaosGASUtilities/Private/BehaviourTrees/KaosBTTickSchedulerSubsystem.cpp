@@ -0,0 +1,184 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "BehaviourTrees/KaosBTTickSchedulerSubsystem.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(KaosBTTickSchedulerSubsystem)
+
+DECLARE_STATS_GROUP(TEXT("KaosBTTickScheduler"), STATGROUP_KaosBTTickScheduler, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered"), STAT_KaosBTTickScheduler_Registered, STATGROUP_KaosBTTickScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Evaluated"), STAT_KaosBTTickScheduler_Evaluated, STATGROUP_KaosBTTickScheduler);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Deferred"), STAT_KaosBTTickScheduler_Deferred, STATGROUP_KaosBTTickScheduler);
+
+UKaosBTTickSchedulerSubsystem* UKaosBTTickSchedulerSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UKaosBTTickSchedulerSubsystem>() : nullptr;
+}
+
+FKaosBTTickSchedulerHandle UKaosBTTickSchedulerSubsystem::RegisterEvaluation(const UBehaviorTreeComponent& OwnerComp, float Interval, float RandomDeviation, FKaosScheduledBTTick Evaluation)
+{
+	const AAIController* AIOwner = OwnerComp.GetAIOwner();
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	FKaosScheduledEvaluation ScheduledEvaluation;
+	ScheduledEvaluation.Agent = AIOwner && AIOwner->GetPawn() ? static_cast<const AActor*>(AIOwner->GetPawn()) : OwnerComp.GetOwner();
+	ScheduledEvaluation.Evaluation = MoveTemp(Evaluation);
+	ScheduledEvaluation.Interval = FMath::Max(Interval, 0.f);
+	ScheduledEvaluation.RandomDeviation = FMath::Clamp(RandomDeviation, 0.f, ScheduledEvaluation.Interval);
+	ScheduledEvaluation.LastRunTime = CurrentTime;
+	ScheduledEvaluation.Serial = NextSerial++;
+
+	// Spread the first run over the interval so agents registered together do not stay in step
+	ScheduledEvaluation.NextDueTime = CurrentTime + FMath::FRandRange(0.f, ScheduledEvaluation.Interval);
+
+	FKaosBTTickSchedulerHandle Handle;
+	Handle.Serial = ScheduledEvaluation.Serial;
+	Handle.Index = Evaluations.Add(MoveTemp(ScheduledEvaluation));
+	return Handle;
+}
+
+void UKaosBTTickSchedulerSubsystem::UnregisterEvaluation(FKaosBTTickSchedulerHandle& Handle)
+{
+	if (Handle.IsValid() && Evaluations.IsValidIndex(Handle.Index) && Evaluations[Handle.Index].Serial == Handle.Serial)
+	{
+		Evaluations.RemoveAt(Handle.Index);
+	}
+	Handle.Reset();
+}
+
+float UKaosBTTickSchedulerSubsystem::GetNextInterval(const FKaosScheduledEvaluation& ScheduledEvaluation)
+{
+	return ScheduledEvaluation.RandomDeviation > 0.f
+		? ScheduledEvaluation.Interval + FMath::FRandRange(-ScheduledEvaluation.RandomDeviation, ScheduledEvaluation.RandomDeviation)
+		: ScheduledEvaluation.Interval;
+}
+
+float UKaosBTTickSchedulerSubsystem::GetRelevancy(const AActor* Agent, TConstArrayView<FVector> PlayerLocations) const
+{
+	if (!Agent || PlayerLocations.IsEmpty() || PriorityDistance <= 0.f)
+	{
+		return 1.f;
+	}
+
+	const FVector AgentLocation = Agent->GetActorLocation();
+	float ClosestDistanceSq = UE_MAX_FLT;
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		ClosestDistanceSq = FMath::Min(ClosestDistanceSq, static_cast<float>(FVector::DistSquared(AgentLocation, PlayerLocation)));
+	}
+
+	// 2 next to a player, 1 at PriorityDistance, tending to 0 far away
+	return 2.f / (1.f + FMath::Sqrt(ClosestDistanceSq) / PriorityDistance);
+}
+
+void UKaosBTTickSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (const APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(PlayerPawn->GetActorLocation());
+		}
+	}
+
+	// Priority grows with time overdue relative to the interval, so far away agents age into running instead of starving
+	DueEvaluations.Reset();
+	for (auto It = Evaluations.CreateConstIterator(); It; ++It)
+	{
+		const FKaosScheduledEvaluation& ScheduledEvaluation = *It;
+		if (ScheduledEvaluation.NextDueTime <= CurrentTime)
+		{
+			const float Overdue = static_cast<float>(CurrentTime - ScheduledEvaluation.NextDueTime) + ScheduledEvaluation.Interval;
+			const float Priority = Overdue / FMath::Max(ScheduledEvaluation.Interval, UE_KINDA_SMALL_NUMBER) * GetRelevancy(ScheduledEvaluation.Agent.Get(), PlayerLocations);
+			DueEvaluations.Emplace(Priority, FKaosBTTickSchedulerHandle{ It.GetIndex(), ScheduledEvaluation.Serial });
+		}
+	}
+	DueEvaluations.Sort([](const TPair<float, FKaosBTTickSchedulerHandle>& A, const TPair<float, FKaosBTTickSchedulerHandle>& B) { return A.Key > B.Key; });
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double BudgetSeconds = FrameBudgetMilliseconds / 1000.0;
+	int32 NumEvaluated = 0;
+	int32 NumDeferred = 0;
+	for (const TPair<float, FKaosBTTickSchedulerHandle>& DueEvaluation : DueEvaluations)
+	{
+		// An earlier evaluation may have unregistered this one, and registered another into its slot
+		const FKaosBTTickSchedulerHandle& Handle = DueEvaluation.Value;
+		if (!Evaluations.IsAllocated(Handle.Index) || Evaluations[Handle.Index].Serial != Handle.Serial)
+		{
+			continue;
+		}
+
+		// Still due, so it is picked up again next frame
+		if (NumDeferred > 0 || (NumEvaluated >= MinEvaluationsPerFrame && FPlatformTime::Seconds() - StartTime >= BudgetSeconds))
+		{
+			++NumDeferred;
+			continue;
+		}
+
+		FKaosScheduledEvaluation& ScheduledEvaluation = Evaluations[Handle.Index];
+		const float DeltaSeconds = static_cast<float>(CurrentTime - ScheduledEvaluation.LastRunTime);
+		Stats.MaxOverdueSeconds = FMath::Max(Stats.MaxOverdueSeconds, CurrentTime - ScheduledEvaluation.NextDueTime);
+		ScheduledEvaluation.LastRunTime = CurrentTime;
+		ScheduledEvaluation.NextDueTime = CurrentTime + GetNextInterval(ScheduledEvaluation);
+
+		// Copied as the evaluation may register or unregister evaluations, moving the sparse array
+		const FKaosScheduledBTTick Evaluation = ScheduledEvaluation.Evaluation;
+		Evaluation.ExecuteIfBound(DeltaSeconds);
+		++NumEvaluated;
+	}
+
+	Stats.NumRegistered = Evaluations.Num();
+	Stats.NumDueLastFrame = DueEvaluations.Num();
+	Stats.NumEvaluatedLastFrame = NumEvaluated;
+	Stats.NumDeferredLastFrame = NumDeferred;
+	Stats.LastFrameMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	Stats.TotalEvaluations += NumEvaluated;
+	Stats.TotalDeferred += Stats.NumDeferredLastFrame;
+
+	SET_DWORD_STAT(STAT_KaosBTTickScheduler_Registered, Stats.NumRegistered);
+	SET_DWORD_STAT(STAT_KaosBTTickScheduler_Evaluated, Stats.NumEvaluatedLastFrame);
+	SET_DWORD_STAT(STAT_KaosBTTickScheduler_Deferred, Stats.NumDeferredLastFrame);
+}
+
+bool UKaosBTTickSchedulerSubsystem::IsTickable() const
+{
+	return Evaluations.Num() > 0;
+}
+
+TStatId UKaosBTTickSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UKaosBTTickSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UKaosBTTickSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,208 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include "BehaviourTrees/KaosRangeCheckSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(KaosRangeCheckSubsystem)
+
+UKaosRangeCheckSubsystem* UKaosRangeCheckSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UKaosRangeCheckSubsystem>() : nullptr;
+}
+
+FKaosRangeCheckHandle UKaosRangeCheckSubsystem::RegisterRangeCheck(const AActor* SourceActor, const AActor* TargetActor, float Range, float Hysteresis, FKaosOnRangeCheckChanged OnChanged, float MaxStaleness)
+{
+	FKaosRangeCheck RangeCheck;
+	RangeCheck.SourceActor = SourceActor;
+	RangeCheck.TargetActor = TargetActor;
+	RangeCheck.Range = Range;
+	RangeCheck.ExitRange = Range + FMath::Max(Hysteresis, 0.f);
+	RangeCheck.MaxStaleness = FMath::Max(MaxStaleness, 0.f);
+	RangeCheck.Serial = NextSerial++;
+	RangeCheck.OnChanged = MoveTemp(OnChanged);
+	EvaluateRangeCheck(RangeCheck, GetWorld()->GetTimeSeconds());
+
+	FKaosRangeCheckHandle Handle;
+	Handle.Serial = RangeCheck.Serial;
+	Handle.Index = RangeChecks.Add(MoveTemp(RangeCheck));
+	return Handle;
+}
+
+void UKaosRangeCheckSubsystem::UnregisterRangeCheck(FKaosRangeCheckHandle& Handle)
+{
+	if (FindRangeCheck(Handle))
+	{
+		RangeChecks.RemoveAt(Handle.Index);
+	}
+	Handle.Reset();
+}
+
+void UKaosRangeCheckSubsystem::SetRangeCheckActors(const FKaosRangeCheckHandle& Handle, const AActor* SourceActor, const AActor* TargetActor)
+{
+	if (!FindRangeCheck(Handle))
+	{
+		return;
+	}
+
+	FKaosRangeCheck& RangeCheck = RangeChecks[Handle.Index];
+	RangeCheck.SourceActor = SourceActor;
+	RangeCheck.TargetActor = TargetActor;
+	if (EvaluateRangeCheck(RangeCheck, GetWorld()->GetTimeSeconds()))
+	{
+		RangeCheck.OnChanged.ExecuteIfBound(RangeCheck.bInRange);
+	}
+}
+
+bool UKaosRangeCheckSubsystem::IsInRange(const FKaosRangeCheckHandle& Handle) const
+{
+	const FKaosRangeCheck* RangeCheck = FindRangeCheck(Handle);
+	return RangeCheck && RangeCheck->bInRange;
+}
+
+void UKaosRangeCheckSubsystem::NotifyActorTeleported(const AActor* Actor)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+	// Delegates fire once the pass is done, they may register or unregister range checks
+	TArray<FKaosRangeCheckHandle, TInlineAllocator<16>> ChangedRangeChecks;
+	for (auto It = RangeChecks.CreateIterator(); It; ++It)
+	{
+		FKaosRangeCheck& RangeCheck = *It;
+		if ((RangeCheck.SourceActor.Get() == Actor || RangeCheck.TargetActor.Get() == Actor) && EvaluateRangeCheck(RangeCheck, CurrentTime))
+		{
+			ChangedRangeChecks.Add({ It.GetIndex(), RangeCheck.Serial });
+		}
+	}
+
+	for (const FKaosRangeCheckHandle& Handle : ChangedRangeChecks)
+	{
+		if (const FKaosRangeCheck* RangeCheck = FindRangeCheck(Handle))
+		{
+			RangeCheck->OnChanged.ExecuteIfBound(RangeCheck->bInRange);
+		}
+	}
+}
+
+const UKaosRangeCheckSubsystem::FKaosRangeCheck* UKaosRangeCheckSubsystem::FindRangeCheck(const FKaosRangeCheckHandle& Handle) const
+{
+	if (Handle.IsValid() && RangeChecks.IsValidIndex(Handle.Index) && RangeChecks[Handle.Index].Serial == Handle.Serial)
+	{
+		return &RangeChecks[Handle.Index];
+	}
+	return nullptr;
+}
+
+bool UKaosRangeCheckSubsystem::EvaluateRangeCheck(FKaosRangeCheck& RangeCheck, double CurrentTime) const
+{
+	const AActor* SourceActor = RangeCheck.SourceActor.Get();
+	const AActor* TargetActor = RangeCheck.TargetActor.Get();
+
+	bool bInRange = false;
+	float Slack = MaxClosingSpeed * MaxCheckInterval;
+	if (SourceActor && TargetActor)
+	{
+		const float Distance = FVector::Dist(SourceActor->GetActorLocation(), TargetActor->GetActorLocation());
+		bInRange = Distance <= (RangeCheck.bInRange ? RangeCheck.ExitRange : RangeCheck.Range);
+
+		// Distance left before the result can flip, the threshold to leave range is the wider one
+		Slack = FMath::Abs(Distance - (bInRange ? RangeCheck.ExitRange : RangeCheck.Range));
+	}
+
+	const float MaxInterval = RangeCheck.MaxStaleness > 0.f ? FMath::Min(RangeCheck.MaxStaleness, MaxCheckInterval) : MaxCheckInterval;
+	const float MinInterval = FMath::Min(MinCheckInterval, MaxInterval);
+	const float CheckInterval = MaxClosingSpeed > 0.f ? FMath::Clamp(Slack / MaxClosingSpeed, MinInterval, MaxInterval) : MinInterval;
+	RangeCheck.NextCheckTime = CurrentTime + CheckInterval;
+
+	const bool bChanged = bInRange != RangeCheck.bInRange;
+	RangeCheck.bInRange = bInRange;
+	return bChanged;
+}
+
+void UKaosRangeCheckSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double CurrentTime = GetWorld()->GetTimeSeconds();
+	const int32 MaxIndex = RangeChecks.GetMaxIndex();
+	if (NextCheckIndex >= MaxIndex)
+	{
+		NextCheckIndex = 0;
+	}
+
+	// Delegates fire once the pass is done, they may register or unregister range checks
+	TArray<FKaosRangeCheckHandle, TInlineAllocator<16>> ChangedRangeChecks;
+
+	int32 NumChecked = 0;
+	for (int32 Step = 0; Step < MaxIndex && NumChecked < MaxChecksPerFrame; ++Step)
+	{
+		const int32 Index = (NextCheckIndex + Step) % MaxIndex;
+		if (!RangeChecks.IsAllocated(Index))
+		{
+			continue;
+		}
+
+		FKaosRangeCheck& RangeCheck = RangeChecks[Index];
+		if (RangeCheck.NextCheckTime > CurrentTime)
+		{
+			continue;
+		}
+
+		++NumChecked;
+		if (EvaluateRangeCheck(RangeCheck, CurrentTime))
+		{
+			ChangedRangeChecks.Add({ Index, RangeCheck.Serial });
+		}
+
+		if (NumChecked == MaxChecksPerFrame)
+		{
+			NextCheckIndex = Index + 1;
+		}
+	}
+
+	for (const FKaosRangeCheckHandle& Handle : ChangedRangeChecks)
+	{
+		if (const FKaosRangeCheck* RangeCheck = FindRangeCheck(Handle))
+		{
+			RangeCheck->OnChanged.ExecuteIfBound(RangeCheck->bInRange);
+		}
+	}
+}
+
+bool UKaosRangeCheckSubsystem::IsTickable() const
+{
+	return RangeChecks.Num() > 0;
+}
+
+TStatId UKaosRangeCheckSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UKaosRangeCheckSubsystem, STATGROUP_Tickables);
+}
+
+bool UKaosRangeCheckSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
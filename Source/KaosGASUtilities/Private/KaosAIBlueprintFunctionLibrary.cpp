@@ -144,6 +144,90 @@ bool UKaosAIBlueprintFunctionLibrary::IsHostileOrNeutralInterface(TScriptInterfa
 	return GetAttitudeTowards_Internal(TeamAgentA, TeamAgentB) != ETeamAttitude::Friendly;
 }
 
+TArray<AActor*> UKaosAIBlueprintFunctionLibrary::FilterActorsByAttitude(const AActor* Source, const TArray<AActor*>& Candidates, TEnumAsByte<ETeamAttitude::Type> Attitude)
+{
+	TBitArray<> Mask;
+	GetAttitudeMask(Source, Candidates, Attitude, Mask);
+
+	TArray<AActor*> FilteredActors;
+	for (TConstSetBitIterator<> It(Mask); It; ++It)
+	{
+		FilteredActors.Add(Candidates[It.GetIndex()]);
+	}
+	return FilteredActors;
+}
+
+void UKaosAIBlueprintFunctionLibrary::GetTeamIds(TConstArrayView<AActor*> Actors, TArray<uint8>& OutTeamIds)
+{
+	OutTeamIds.SetNumUninitialized(Actors.Num());
+	for (int32 Index = 0; Index < Actors.Num(); ++Index)
+	{
+		const IGenericTeamAgentInterface* TeamAgent = Cast<const IGenericTeamAgentInterface>(Actors[Index]);
+		OutTeamIds[Index] = TeamAgent ? TeamAgent->GetGenericTeamId().GetId() : FGenericTeamId::NoTeam.GetId();
+	}
+}
+
+void UKaosAIBlueprintFunctionLibrary::GetAttitudeMask(const AActor* Source, TConstArrayView<AActor*> Candidates, ETeamAttitude::Type Attitude, TBitArray<>& OutMask)
+{
+	const IGenericTeamAgentInterface* SourceTeamAgent = Cast<const IGenericTeamAgentInterface>(Source);
+	const FGenericTeamId SourceTeamId = SourceTeamAgent ? SourceTeamAgent->GetGenericTeamId() : FGenericTeamId::NoTeam;
+
+	TArray<uint8> CandidateTeamIds;
+	GetTeamIds(Candidates, CandidateTeamIds);
+
+	GetAttitudeMaskFromTeamIds(SourceTeamId, CandidateTeamIds, Attitude, OutMask);
+}
+
+namespace KaosAIBlueprintFunctionLibrary
+{
+	/** Packs the results of Matches for 32 team ids at a time into the words of OutMask, a branch free loop the compiler can vectorise */
+	template <typename FMatches>
+	static void BuildAttitudeMask(TConstArrayView<uint8> TeamIds, TBitArray<>& OutMask, FMatches Matches)
+	{
+		const int32 NumIds = TeamIds.Num();
+		OutMask.Init(false, NumIds);
+		uint32* Words = OutMask.GetData();
+
+		for (int32 First = 0; First < NumIds; First += NumBitsPerDWORD)
+		{
+			const int32 Count = FMath::Min<int32>(NumBitsPerDWORD, NumIds - First);
+			uint32 Word = 0;
+			for (int32 Bit = 0; Bit < Count; ++Bit)
+			{
+				Word |= static_cast<uint32>(Matches(TeamIds[First + Bit])) << Bit;
+			}
+			Words[First / NumBitsPerDWORD] = Word;
+		}
+	}
+}
+
+void UKaosAIBlueprintFunctionLibrary::GetAttitudeMaskFromTeamIds(FGenericTeamId SourceTeamId, TConstArrayView<uint8> CandidateTeamIds, ETeamAttitude::Type Attitude, TBitArray<>& OutMask)
+{
+	using namespace KaosAIBlueprintFunctionLibrary;
+
+	// Same rules as GetAttitudeTowards_Internal, a source without a team is neutral towards everyone
+	const uint8 SourceId = SourceTeamId.GetId();
+	const uint8 NoTeamId = FGenericTeamId::NoTeam.GetId();
+	if (SourceId == NoTeamId)
+	{
+		OutMask.Init(Attitude == ETeamAttitude::Neutral, CandidateTeamIds.Num());
+		return;
+	}
+
+	switch (Attitude)
+	{
+	case ETeamAttitude::Friendly:
+		BuildAttitudeMask(CandidateTeamIds, OutMask, [SourceId](uint8 TeamId) { return TeamId == SourceId; });
+		break;
+	case ETeamAttitude::Hostile:
+		BuildAttitudeMask(CandidateTeamIds, OutMask, [SourceId, NoTeamId](uint8 TeamId) { return (TeamId != SourceId) & (TeamId != NoTeamId); });
+		break;
+	default:
+		BuildAttitudeMask(CandidateTeamIds, OutMask, [NoTeamId](uint8 TeamId) { return TeamId == NoTeamId; });
+		break;
+	}
+}
+
 UNavigationSystemV1* UKaosAIBlueprintFunctionLibrary::GetNavigationSystem(const UObject* WorldContextObject)
 {
 	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
@@ -197,10 +281,12 @@ TEnumAsByte<ETeamAttitude::Type> UKaosAIBlueprintFunctionLibrary::GetAttitudeTow
 		return ETeamAttitude::Neutral;
 	}
 
-	if (A->GetGenericTeamId() == 255 || B->GetGenericTeamId() == 255)
+	const FGenericTeamId TeamIdA = A->GetGenericTeamId();
+	const FGenericTeamId TeamIdB = B->GetGenericTeamId();
+	if (TeamIdA == 255 || TeamIdB == 255)
 	{
 		return ETeamAttitude::Neutral;
 	}
 
-	return A->GetGenericTeamId() != B->GetGenericTeamId() ? ETeamAttitude::Hostile : ETeamAttitude::Friendly;
+	return TeamIdA != TeamIdB ? ETeamAttitude::Hostile : ETeamAttitude::Friendly;
 }
@@ -1,4 +1,4 @@
-// Copyright (C) 2024, Daniel Moss
+﻿// Copyright (C) 2024, Daniel Moss
 // 
 // Permission is hereby granted, free of charge, to any person obtaining a
 // copy of this software and associated documentation files (the "Software"),
@@ -19,18 +19,24 @@
 // DEALINGS IN THE SOFTWARE.
 
 #include "KaosGASUtilities.h"
+#include "AbilitySystem/KaosUtilitiesBlueprintLibrary.h"
 
 #define LOCTEXT_NAMESPACE "FKaosGASUtilitiesModule"
 
+FKaosGameplayAttributeChangedEventWrapperSpecPool* FKaosGASUtilitiesModule::EventWrapperSpecPool = nullptr;
+
 void FKaosGASUtilitiesModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	EventWrapperSpecPool = new FKaosGameplayAttributeChangedEventWrapperSpecPool();
 }
 
 void FKaosGASUtilitiesModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	delete EventWrapperSpecPool;
+	EventWrapperSpecPool = nullptr;
 }
 
 #undef LOCTEXT_NAMESPACE
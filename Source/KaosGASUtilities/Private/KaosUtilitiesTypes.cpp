@@ -21,10 +21,59 @@
 #include "KaosUtilitiesTypes.h"
 
 #include "AbilitySystemComponent.h"
+#include "AttributeSet.h"
+#include "GameplayEffect.h"
+#include "Abilities/GameplayAbility.h"
+#include "AbilitySystem/KaosAbilitySystemComponent.h"
 #include "KaosUtilitiesLogging.h"
 #include "Logging/StructuredLog.h"
 
 
+TSubclassOf<UGameplayAbility> FKaosAbilitySet_GameplayAbility::GetAbilityClass() const
+{
+	return Ability ? Ability.Get() : SoftAbility.Get();
+}
+
+TSubclassOf<UGameplayAbility> FKaosAbilitySet_GameplayAbility::LoadAbilityClass() const
+{
+	return Ability ? Ability.Get() : SoftAbility.LoadSynchronous();
+}
+
+FSoftObjectPath FKaosAbilitySet_GameplayAbility::GetAbilityClassPath() const
+{
+	return Ability ? FSoftObjectPath(Ability.Get()) : SoftAbility.ToSoftObjectPath();
+}
+
+TSubclassOf<UGameplayEffect> FKaosAbilitySet_GameplayEffect::GetGameplayEffectClass() const
+{
+	return GameplayEffect ? GameplayEffect.Get() : SoftGameplayEffect.Get();
+}
+
+TSubclassOf<UGameplayEffect> FKaosAbilitySet_GameplayEffect::LoadGameplayEffectClass() const
+{
+	return GameplayEffect ? GameplayEffect.Get() : SoftGameplayEffect.LoadSynchronous();
+}
+
+FSoftObjectPath FKaosAbilitySet_GameplayEffect::GetGameplayEffectClassPath() const
+{
+	return GameplayEffect ? FSoftObjectPath(GameplayEffect.Get()) : SoftGameplayEffect.ToSoftObjectPath();
+}
+
+TSubclassOf<UAttributeSet> FKaosAbilitySet_AttributeSet::GetAttributeSetClass() const
+{
+	return AttributeSet ? AttributeSet.Get() : SoftAttributeSet.Get();
+}
+
+TSubclassOf<UAttributeSet> FKaosAbilitySet_AttributeSet::LoadAttributeSetClass() const
+{
+	return AttributeSet ? AttributeSet.Get() : SoftAttributeSet.LoadSynchronous();
+}
+
+FSoftObjectPath FKaosAbilitySet_AttributeSet::GetAttributeSetClassPath() const
+{
+	return AttributeSet ? FSoftObjectPath(AttributeSet.Get()) : SoftAttributeSet.ToSoftObjectPath();
+}
+
 void FKaosAbilitySetHandle::RemoveSet()
 {
 	if (!AbilitySystemComponent->IsOwnerActorAuthoritative())
@@ -33,11 +82,27 @@ void FKaosAbilitySetHandle::RemoveSet()
 		return;
 	}
 
+	// The Kaos ASC owns the authoritative record, this handle may be a stale copy of a set that has already been removed.
+	if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(AbilitySystemComponent.Get()))
+	{
+		KaosAbilitySystemComponent->RemoveGrantedAbilitySet(HandleId);
+	}
+	else
+	{
+		RemoveGrantedItems(*AbilitySystemComponent);
+	}
+
+	UE_LOGFMT(LogKaosUtilities, Log, "Removed ability set with handle {Handle}", HandleId);
+	Reset();
+}
+
+void FKaosAbilitySetHandle::RemoveGrantedItems(UAbilitySystemComponent& InAbilitySystemComponent) const
+{
 	for (const FGameplayAbilitySpecHandle& Handle : AbilitySpecHandles)
 	{
 		if (Handle.IsValid())
 		{
-			AbilitySystemComponent->ClearAbility(Handle);
+			InAbilitySystemComponent.ClearAbility(Handle);
 		}
 	}
 
@@ -45,21 +110,33 @@ void FKaosAbilitySetHandle::RemoveSet()
 	{
 		if (Handle.IsValid())
 		{
-			AbilitySystemComponent->RemoveActiveGameplayEffect(Handle);
+			InAbilitySystemComponent.RemoveActiveGameplayEffect(Handle);
 		}
 	}
 
-	// We do NOT remove any spawned sets.
+	// By default we do NOT remove any spawned sets.
 	// This is because GameplayEffects from other things MIGHT be interacting with them and we CAN NOT
 	// for sure know WHAT and WHY without expensive lookups. Also we might not know in the future.
-	
-	// for (UAttributeSet* Set : AttributeSets)
-	// {
-	// 	AbilitySystemComponent->RemoveSpawnedAttribute(Set);
-	// }
+	// Only sets the ability set explicitly flagged with bReleaseWithAbilitySet are tracked here.
+	for (const TWeakObjectPtr<UAttributeSet>& Set : AttributeSets)
+	{
+		if (Set.IsValid())
+		{
+			ReleaseAttributeSet(InAbilitySystemComponent, Set.Get());
+		}
+	}
+}
 
-	UE_LOGFMT(LogKaosUtilities, Log, "Removed ability set with handle {Handle}", HandleId);
-	Reset();
+void FKaosAbilitySetHandle::ReleaseAttributeSet(UAbilitySystemComponent& InAbilitySystemComponent, UAttributeSet* Set)
+{
+	if (UKaosAbilitySystemComponent* KaosAbilitySystemComponent = Cast<UKaosAbilitySystemComponent>(&InAbilitySystemComponent))
+	{
+		KaosAbilitySystemComponent->ReleaseAttributeSet(Set);
+	}
+	else
+	{
+		InAbilitySystemComponent.RemoveSpawnedAttribute(Set);
+	}
 }
 
 void FKaosAbilitySetHandle::AddAbilitySpecHandle(const FGameplayAbilitySpecHandle& Handle)
@@ -78,3 +155,10 @@ void FKaosAbilitySetHandle::AddGameplayEffectHandle(const FActiveGameplayEffectH
 	}
 }
 
+void FKaosAbilitySetHandle::AddAttributeSet(UAttributeSet* Set)
+{
+	if (Set)
+	{
+		AttributeSets.Add(Set);
+	}
+}
@@ -22,12 +22,43 @@
 
 #include "CoreMinimal.h"
 #include "AbilitySystemComponent.h"
+#include "KaosUtilitiesTypes.h"
 #include "UObject/Object.h"
 #include "KaosAbilitySystemComponent.generated.h"
 
 class UKaosGameplayAbility;
 class UKaosAbilityTagRelationships;
+struct FKaosGameplayAttributeChangedEventWrapperSpec;
+class FKaosAttributeChangeBuffer;
 DECLARE_DELEGATE_OneParam(FKaosOnGiveAbility, FGameplayAbilitySpec&);
+DECLARE_MULTICAST_DELEGATE(FKaosOnAbilityBlockTagsChanged);
+DECLARE_MULTICAST_DELEGATE_OneParam(FKaosOnAbilitySpecChanged, const FGameplayAbilitySpec&);
+
+/** What the ForEachActiveEffect visitor wants done after visiting an effect */
+enum class EKaosActiveEffectVisitResult : uint8
+{
+	/** Keep visiting */
+	Continue = 0,
+	/** The effect was mutated and needs marking dirty for replication */
+	MarkDirty = 1 << 0,
+	/** Stop visiting */
+	Stop = 1 << 1,
+};
+ENUM_CLASS_FLAGS(EKaosActiveEffectVisitResult);
+
+/**
+ * Batches a run of ability grants on a Kaos ASC. The ability list stays locked so the specs are added together once the scope
+ * closes, passive abilities are activated after everything in the batch has been granted, and replication is forced once.
+ */
+struct KAOSGASUTILITIES_API FKaosScopedAbilityGrantBatch
+{
+	FKaosScopedAbilityGrantBatch(UKaosAbilitySystemComponent& InAbilitySystemComponent, int32 NumAbilitiesToGrant = 0);
+	~FKaosScopedAbilityGrantBatch();
+
+private:
+	UKaosAbilitySystemComponent& AbilitySystemComponent;
+	TOptional<FScopedAbilityListLock> AbilityListLock;
+};
 
 /**
  * 
@@ -42,6 +73,9 @@ public:
 	                                            const FGameplayTagContainer& CancelTags) override;
 	virtual void NotifyAbilityFailed(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason) override;
 	virtual void NotifyAbilityEnded(FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability, bool bWasCancelled) override;
+	virtual void CaptureAttributeForGameplayEffect(FGameplayEffectAttributeCaptureSpec& OutCaptureSpec) override;
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 
 	/** Helper function for blueprint to get abilities TargetData */
 	UFUNCTION(BlueprintCallable)
@@ -61,10 +95,17 @@ public:
 	/** Returns all active gameplay effect handles */
 	TArray<FActiveGameplayEffectHandle> GetAllActiveEffectHandles() const;
 
+	/**
+	 * Visits every active effect matching Query without allocating. Effects the visitor reports as mutated are marked dirty once the visit
+	 * has finished. Do not apply or remove effects from inside the visitor.
+	 */
+	void ForEachActiveEffect(const FGameplayEffectQuery& Query, TFunctionRef<EKaosActiveEffectVisitResult(FActiveGameplayEffect&)> Visitor);
+
 	/** Accessor for the OnGiveAbility delegate */
 	FKaosOnGiveAbility& GetKaosOnGiveAbilityDelegate() { return KaosOnGiveAbility; }
 
-	virtual bool CanApplyAttributeModifiers(FGameplayEffectSpec EffectSpec);
+	/** Returns true if applying the additive modifiers of EffectSpec would not take any attribute below zero. Static effects use cached magnitudes. */
+	virtual bool CanApplyAttributeModifiers(const FGameplayEffectSpec& EffectSpec);
 
 	/** Marks the ActiveGameplayEffect as dirty for replication purposes */
 	void MarkActiveGameplayEffectDirty(FActiveGameplayEffect* ActiveGE);
@@ -134,6 +175,79 @@ public:
 	UFUNCTION(BlueprintCallable, meta=(Categories="AbilityTagCategory"))
 	bool CanActivateAbilityWithAllMatchingTags(const FGameplayTagContainer GameplayAbilityTags, FGameplayTagContainer& OutFailureTags);
 
+	/** Records an ability set granted to this component so it can later be removed by handle id or in bulk */
+	void RegisterGrantedAbilitySet(const FKaosAbilitySetHandle& Handle);
+
+	/** Removes everything granted by the ability set with HandleId. Returns false if it is not granted to this component (anymore). */
+	bool RemoveGrantedAbilitySet(int32 HandleId);
+
+	/** Stops tracking the ability set with HandleId without removing what it granted, the record is copied to OutGrantedSet */
+	bool UnregisterGrantedAbilitySet(int32 HandleId, FKaosAbilitySetHandle& OutGrantedSet);
+
+	/** Removes everything granted by every ability set, cost is proportional to the number of granted items */
+	void RemoveAllGrantedAbilitySets();
+
+	/** Are we inside a FKaosScopedAbilityGrantBatch */
+	bool IsGrantingAbilityBatch() const { return AbilityGrantBatchDepth > 0; }
+
+	/** Queues a passive ability to be activated once the current grant batch closes */
+	void DeferPassiveAbilityActivation(const FGameplayAbilitySpecHandle& Handle);
+
+	/** Adds an instance of AttributeSetClass to this component, reusing a pooled instance reset to class defaults when there is one */
+	UAttributeSet* AcquireAttributeSet(TSubclassOf<UAttributeSet> AttributeSetClass);
+
+	/** Removes AttributeSet from this component and keeps it pooled for the next AcquireAttributeSet of its class */
+	void ReleaseAttributeSet(UAttributeSet* AttributeSet);
+
+	/** Drops every pooled attribute set, letting GC collect them */
+	void EmptyAttributeSetPool();
+
+	/** Returns the record of a granted ability set, or nullptr if it is not granted to this component */
+	const FKaosAbilitySetHandle* FindGrantedAbilitySet(int32 HandleId) const { return GrantedAbilitySets.Find(HandleId); }
+
+	/** False while no duration effect has modified Attribute and it has never been captured, its value can then be written without going through an aggregator */
+	bool MayHaveAttributeAggregator(const FGameplayAttribute& Attribute) const { return AttributesWithAggregators.Contains(Attribute); }
+
+	/** Records the attribute defaults group and level this component was initialized with */
+	void SetAttributeDefaultsGroup(FName GroupName, int32 Level) { AttributeDefaultsGroup = GroupName; AttributeDefaultsLevel = Level; }
+
+	/** Attribute defaults group this component was last initialized with, None if it never was */
+	FName GetAttributeDefaultsGroup() const { return AttributeDefaultsGroup; }
+
+	/** Level this component last had its attribute defaults initialized at */
+	int32 GetAttributeDefaultsLevel() const { return AttributeDefaultsLevel; }
+
+	/** Keeps an attribute changed event wrapper bound to this component alive until it is unbound or the component is unregistered */
+	void RegisterAttributeChangedEventWrapper(const TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec>& EventWrapper);
+
+	/** Releases an event wrapper that no longer has any binding to this component */
+	void UnregisterAttributeChangedEventWrapper(const FKaosGameplayAttributeChangedEventWrapperSpec* EventWrapper);
+
+	/** Unbinds every attribute changed event wrapper still bound to this component */
+	void ReleaseAttributeChangedEventWrappers();
+
+	/** Called whenever abilities are blocked or unblocked by tags, blocked ability tags do not raise gameplay tag events */
+	FKaosOnAbilityBlockTagsChanged OnAbilityBlockTagsChanged;
+
+	/** Called when an ability is granted, on the server and when the spec replicates to clients */
+	FKaosOnAbilitySpecChanged OnAbilityGranted;
+
+	/** Called when an ability is about to be removed, the spec is still in the activatable abilities while this runs */
+	FKaosOnAbilitySpecChanged OnAbilityRemoved;
+
+	/**
+	 * Starts recording every change of Attributes, or of every attribute of the spawned attribute sets if empty, into a ring buffer of
+	 * Capacity records. Replaces any previous recording. The returned buffer can be drained in bulk from one consumer on any thread
+	 * and stays valid after recording stops.
+	 */
+	TSharedRef<FKaosAttributeChangeBuffer> StartRecordingAttributeChanges(TConstArrayView<FGameplayAttribute> Attributes, uint32 Capacity = 1024);
+
+	/** Stops feeding the attribute change buffer */
+	void StopRecordingAttributeChanges();
+
+	/** The buffer attribute changes are currently recorded into, null when not recording */
+	TSharedPtr<FKaosAttributeChangeBuffer> GetAttributeChangeBuffer() const { return AttributeChangeBuffer; }
+
 protected:
 	
 	FGameplayAbilitySpec* FindAbilitySpecFromTag(FGameplayTag Tag);
@@ -150,10 +264,53 @@ protected:
 	/** Notify the ability it failed */
 	virtual void HandleAbilityFailed(const UGameplayAbility* Ability, const FGameplayTagContainer& FailureReason);
 
+	virtual void OnGiveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+	virtual void OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec) override;
+
 	/** Callback when an ability is given */
 	FKaosOnGiveAbility KaosOnGiveAbility;
 
 	//Mapping of abilities tags to block and cancel tags. Can be overriden using GetAbilityTagRelationships()
 	UPROPERTY(EditDefaultsOnly, Category = "Relationship")
 	TObjectPtr<UKaosAbilityTagRelationships> AbilityTagRelationship;
+
+private:
+	friend struct FKaosScopedAbilityGrantBatch;
+
+	void BeginAbilityGrantBatch(int32 NumAbilitiesToGrant);
+	void EndAbilityGrantBatch();
+
+	/** Everything granted by ability sets on this component, keyed by set handle id */
+	TMap<int32, FKaosAbilitySetHandle> GrantedAbilitySets;
+
+	/** Number of open FKaosScopedAbilityGrantBatch scopes */
+	int32 AbilityGrantBatchDepth = 0;
+
+	/** Passive abilities granted inside a batch, activated when the outermost batch closes */
+	TArray<FGameplayAbilitySpecHandle> DeferredPassiveAbilities;
+
+	/** Records the attributes a duration effect added on the server or a client creates aggregators for */
+	void OnActiveGameplayEffectAddedToSelf(UAbilitySystemComponent* Target, const FGameplayEffectSpec& SpecApplied, FActiveGameplayEffectHandle ActiveHandle);
+
+	/** Attributes an aggregator may have been created for, by duration effect modifiers or captures, never cleared */
+	TSet<FGameplayAttribute> AttributesWithAggregators;
+
+	FDelegateHandle ActiveGameplayEffectAddedHandle;
+
+	/** Group and level of the last attribute defaults initialization, lets reloaded defaults be re-applied */
+	FName AttributeDefaultsGroup;
+	int32 AttributeDefaultsLevel = 0;
+
+	/** Released attribute sets waiting to be reused, one per class as a component can only own one set of each class */
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UClass>, TObjectPtr<UAttributeSet>> PooledAttributeSets;
+
+	/** Event wrappers bound to this component */
+	TArray<TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>> AttributeChangedEventWrappers;
+
+	void RecordAttributeChange(const FOnAttributeChangeData& ChangeData);
+
+	/** Opt in buffer attribute changes are recorded into, shared with its consumers */
+	TSharedPtr<FKaosAttributeChangeBuffer> AttributeChangeBuffer;
+	TArray<TPair<FGameplayAttribute, FDelegateHandle>> AttributeChangeBufferBindings;
 };
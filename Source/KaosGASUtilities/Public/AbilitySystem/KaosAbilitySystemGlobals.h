@@ -26,6 +26,30 @@
 #include "UObject/Object.h"
 #include "KaosAbilitySystemGlobals.generated.h"
 
+class UGameplayEffect;
+struct FGameplayEffectSpec;
+
+/** Evaluated additive modifier magnitudes of a gameplay effect at a single level. */
+struct KAOSGASUTILITIES_API FKaosCachedModifierMagnitudes
+{
+	/** Returns true if none of the cached magnitudes would take its attribute on the AbilitySystemComponent below zero. */
+	bool CanApplyTo(const UAbilitySystemComponent& AbilitySystemComponent) const;
+
+	/** False if any additive modifier is dynamic (set by caller, attribute based or custom calculation), the spec must then be evaluated instead. */
+	bool bIsStatic = false;
+
+	/** Attribute and evaluated magnitude of every valid additive modifier */
+	TArray<TPair<FGameplayAttribute, float>, TInlineAllocator<2>> AdditiveMagnitudes;
+};
+
+/** An AbilitySystemComponent and the attribute defaults it should be initialized with */
+struct FKaosAttributeSetDefaultsBatchEntry
+{
+	UAbilitySystemComponent* AbilitySystemComponent = nullptr;
+	FKaosAttributeInitializationKey Key;
+	int32 Level = 1;
+};
+
 /**
  * 
  */
@@ -45,10 +69,86 @@ public:
 	void ApplyAttributeSetDefaults(UAbilitySystemComponent* AbilitySystemComponent, FGameplayAttribute& InAttribute, const FKaosAttributeInitializationKey& Key, int32 Level);
 	TArray<float> GetAttributeSetValues(UClass* AttributeSetClass, FProperty* AttributeProperty, const FKaosAttributeInitializationKey& Key) const;
 
+	/** Returns the defaults of an attribute indexed by level - 1 without copying them. The view points into the loaded defaults and is invalidated when they are reloaded. */
+	TConstArrayView<float> GetAttributeSetValuesView(const UClass* AttributeSetClass, const FProperty* AttributeProperty, const FKaosAttributeInitializationKey& Key) const;
+
+	/** Initializes the attribute defaults of every entry in one pass, deferring change broadcasts and replication until all of them are written */
+	void InitAttributeSetDefaultsBatch(TConstArrayView<FKaosAttributeSetDefaultsBatchEntry> Entries, bool bInitialInit);
+
 	virtual TSharedPtr<FKaosAttributeBasics> AllocKaosAttributeBasics() const;
+
+	/** Returns the additive modifier magnitudes of Effect at Level, evaluating and caching them on first use. */
+	const FKaosCachedModifierMagnitudes& GetCachedModifierMagnitudes(const UGameplayEffect* Effect, float Level);
+
+	/** Returns true if none of the additive modifiers of EffectSpec would take its attribute on AbilitySystemComponent below zero. Uses the magnitude cache when the Kaos globals are in use. */
+	static bool CanApplyAttributeModifiers(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayEffectSpec& EffectSpec);
+
+	/** Drops every cached modifier magnitude, scalable floats may have been retuned. */
+	void FlushCachedModifierMagnitudes();
 	
+	virtual void InitAttributeDefaults() override;
 	virtual void ReloadAttributeDefaults() override;
 
+	/** Reparses only CurveTable and patches the loaded attribute defaults in place, instead of rebuilding them from every table */
+	void ReloadAttributeDefaultsTable(const UCurveTable* CurveTable);
+
+	/** Writes the currently loaded curve table defaults to CookedAttributeDefaultsPath, stamped with the identity of the tables they were parsed from */
+	bool WriteCookedAttributeDefaults() const;
+
+	/**
+	 * Stamp identifying the attribute defaults tables and settings, built from the saved package hashes the asset registry records so the
+	 * tables do not have to be loaded. Fails when the registry has no package data for a table, the cooked registry must keep it.
+	 */
+	bool ComputeAttributeDefaultsSourceStamp(uint32& OutSourceStamp) const;
+
+	/** Absolute path of the cooked attribute defaults file */
+	FString GetCookedAttributeDefaultsFilename() const;
+
 protected:
 	virtual void AllocAttributeSetInitter() override;
+
+	/** Re-initialize live Kaos ASCs whose attribute defaults group changed when a single defaults table is reloaded */
+	UPROPERTY(config)
+	bool bReapplyReloadedAttributeDefaults = false;
+
+	/**
+	 * Cooked attribute defaults file, relative to the project directory, written by the KaosWriteAttributeDefaults commandlet.
+	 * When set, non editor processes memory map it instead of parsing the curve tables, unless it was compiled from different tables.
+	 */
+	UPROPERTY(config)
+	FString CookedAttributeDefaultsPath;
+
+	/** How levels between sparse attribute defaults keys are filled in */
+	UPROPERTY(config)
+	EKaosAttributeDefaultsInterpolation AttributeDefaultsInterpolation = EKaosAttributeDefaultsInterpolation::Curve;
+
+	/** How levels past the last attribute defaults key are filled in */
+	UPROPERTY(config)
+	EKaosAttributeDefaultsExtrapolation AttributeDefaultsExtrapolation = EKaosAttributeDefaultsExtrapolation::None;
+
+	/** Highest level attribute defaults are extrapolated to, 0 stops at the last key */
+	UPROPERTY(config)
+	int32 AttributeDefaultsMaxLevel = 0;
+
+private:
+	/** Returns the initter group name of Key, "Category.SubCategory" */
+	static FName GetAttributeInitGroupName(const FKaosAttributeInitializationKey& Key);
+
+	void OnAttributeDefaultsTableChanged(TWeakObjectPtr<UCurveTable> CurveTable);
+
+	/** Memory maps the cooked defaults file if its stamp matches the tables, without loading them */
+	bool LoadCookedAttributeDefaults();
+
+	void BindAttributeDefaultsTable(UCurveTable& CurveTable);
+
+	/** Binds the defaults tables a hotfix loads while cooked defaults are in use */
+	void OnEndLoadPackage(const FEndLoadPackageContext& Context);
+
+	FDelegateHandle EndLoadPackageHandle;
+
+	/** Set once a table changed in a process using cooked defaults, from then on the tables are loaded and parsed */
+	bool bParseAttributeDefaultsTables = false;
+
+	/** Additive modifier magnitudes keyed by (effect, level), cost effects are almost always static per level */
+	TMap<TPair<TObjectKey<UGameplayEffect>, float>, FKaosCachedModifierMagnitudes> CachedModifierMagnitudes;
 };
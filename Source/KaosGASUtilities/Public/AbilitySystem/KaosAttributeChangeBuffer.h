@@ -0,0 +1,60 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AttributeSet.h"
+#include "Containers/CircularQueue.h"
+
+/** One attribute change recorded by FKaosAttributeChangeBuffer */
+struct FKaosAttributeChangeRecord
+{
+	/** World time of the change in seconds */
+	double Timestamp = 0.0;
+	FGameplayAttribute Attribute;
+	float OldValue = 0.f;
+	float NewValue = 0.f;
+};
+
+/**
+ * Fixed size ring buffer of attribute changes, filled by an ASC on the game thread and drained in bulk by a single consumer which can be
+ * on any thread. Records that arrive while the buffer is full are dropped and counted rather than overwriting unread records.
+ */
+class KAOSGASUTILITIES_API FKaosAttributeChangeBuffer
+{
+public:
+	/** Capacity is rounded up so that it plus one is a power of two */
+	explicit FKaosAttributeChangeBuffer(uint32 Capacity);
+
+	/** Producer side, returns false if the buffer was full and the record was dropped */
+	bool Record(const FKaosAttributeChangeRecord& ChangeRecord);
+
+	/** Consumer side, appends every record currently in the buffer to OutRecords in the order they were made and returns how many were added */
+	int32 Drain(TArray<FKaosAttributeChangeRecord>& OutRecords);
+
+	/** Number of records dropped because the consumer fell behind */
+	uint64 GetNumDropped() const { return NumDropped.load(std::memory_order_relaxed); }
+
+	bool IsEmpty() const { return Records.IsEmpty(); }
+
+private:
+	TCircularQueue<FKaosAttributeChangeRecord> Records;
+	std::atomic<uint64> NumDropped = 0;
+};
@@ -0,0 +1,192 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UAttributeSet;
+
+/**
+ * Compiled attribute defaults in a flat, index addressed layout. The same bytes are used whether they were built from curve tables at
+ * runtime or memory mapped from a cooked file, a mapped file is read only so every process on a host shares its physical pages.
+ * Only the string, set and property tables are resolved per process.
+ *
+ * Values are stored per (group, set, attribute) as a contiguous array indexed by level - 1, so a single attribute's curve can be
+ * handed out as a view and initializing at a level reads one value per attribute.
+ */
+class KAOSGASUTILITIES_API FKaosAttributeDefaultsData
+{
+public:
+	static constexpr uint32 FileMagic = 0x4444414B; // "KADD"
+	static constexpr uint32 FileVersion = 3;
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumStrings;
+		uint32 StringDataSize;
+		uint32 NumGroups;
+		uint32 NumSets;
+		uint32 NumProperties;
+		uint32 NumGroupSets;
+		uint32 NumColumns;
+		uint32 NumValues;
+		/** Identity of the curve table packages and initter settings the data was compiled from, a mismatch means the file is stale */
+		uint32 SourceHash;
+	};
+
+	/** UTF-8 string in the string data blob, not null terminated */
+	struct FStringEntry
+	{
+		uint32 Offset;
+		uint32 Length;
+	};
+
+	struct FGroupEntry
+	{
+		uint32 NameIndex;
+		/** Highest level any attribute of the group defines */
+		uint32 NumLevels;
+		uint32 FirstGroupSet;
+		uint32 NumGroupSets;
+	};
+
+	/** Attribute set class, stored as its path name */
+	struct FSetEntry
+	{
+		uint32 PathIndex;
+	};
+
+	struct FPropertyEntry
+	{
+		uint32 SetIndex;
+		uint32 NameIndex;
+	};
+
+	/** The attributes of one set within a group */
+	struct FGroupSetEntry
+	{
+		uint32 SetIndex;
+		uint32 FirstColumn;
+		uint32 NumColumns;
+	};
+
+	/** Values of one attribute for levels 1 to NumLevels */
+	struct FColumnEntry
+	{
+		uint32 PropertyIndex;
+		uint32 FirstValue;
+		uint32 NumLevels;
+	};
+
+	FKaosAttributeDefaultsData();
+	~FKaosAttributeDefaultsData();
+
+	/** Takes ownership of compiled data, typically straight from FKaosAttributeDefaultsWriter */
+	bool InitializeFromMemory(TArray<uint8>&& InData);
+
+	/** Memory maps a cooked defaults file, falling back to reading it onto the heap when the platform file can not map it (i.e. inside a pak) */
+	bool InitializeFromFile(const FString& Filename);
+
+	bool IsMapped() const { return MappedRegion.IsValid(); }
+
+	uint32 GetSourceHash() const { return SourceHash; }
+
+	/** Returns the index of GroupName, INDEX_NONE if the group has no defaults */
+	int32 FindGroup(FName GroupName) const;
+
+	int32 GetNumLevels(int32 GroupIndex) const { return Groups[GroupIndex].NumLevels; }
+
+	TConstArrayView<FGroupSetEntry> GetGroupSets(int32 GroupIndex) const { return GroupSets.Slice(Groups[GroupIndex].FirstGroupSet, Groups[GroupIndex].NumGroupSets); }
+
+	TConstArrayView<FColumnEntry> GetColumns(const FGroupSetEntry& GroupSet) const { return Columns.Slice(GroupSet.FirstColumn, GroupSet.NumColumns); }
+
+	/** Values of the column indexed by level - 1 */
+	TConstArrayView<float> GetLevelValues(const FColumnEntry& Column) const { return Values.Slice(Column.FirstValue, Column.NumLevels); }
+
+	/** Returns the column of Property of SetClass in the group, INDEX_NONE if it has no defaults */
+	int32 FindColumn(int32 GroupIndex, const UClass* SetClass, const FProperty* Property) const;
+
+	const FColumnEntry& GetColumn(int32 ColumnIndex) const { return Columns[ColumnIndex]; }
+
+	/** Resolved attribute set class of SetIndex, null if the class no longer exists */
+	UClass* GetSetClass(uint32 SetIndex) const { return SetClasses[SetIndex]; }
+
+	/** Resolved property of PropertyIndex, null if the property no longer exists */
+	FProperty* GetProperty(uint32 PropertyIndex) const { return Properties[PropertyIndex]; }
+
+private:
+	/** Validates the header and section sizes, points the views into the data and resolves names, classes and properties */
+	bool ResolveLayout();
+	FString GetString(uint32 StringIndex) const;
+	void Reset();
+
+	/** Backing storage, either owned heap memory or a mapped file region */
+	TArray<uint8> HeapData;
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	TConstArrayView<FStringEntry> Strings;
+	TConstArrayView<uint8> StringData;
+	TConstArrayView<FGroupEntry> Groups;
+	TConstArrayView<FSetEntry> Sets;
+	TConstArrayView<FPropertyEntry> PropertyEntries;
+	TConstArrayView<FGroupSetEntry> GroupSets;
+	TConstArrayView<FColumnEntry> Columns;
+	TConstArrayView<float> Values;
+
+	TMap<FName, int32> GroupIndices;
+	TMap<TTuple<int32, const UClass*, const FProperty*>, int32> ColumnIndices;
+	TArray<UClass*> SetClasses;
+	TArray<FProperty*> Properties;
+	uint32 SourceHash = 0;
+};
+
+/** Builds the FKaosAttributeDefaultsData layout. Groups are written in the order they are begun. */
+class KAOSGASUTILITIES_API FKaosAttributeDefaultsWriter
+{
+public:
+	void BeginGroup(FName GroupName);
+
+	/** Adds the values of an attribute for levels 1 to LevelValues.Num() to the current group, consecutive columns of the same set are grouped */
+	void AddColumn(const UClass* SetClass, const FProperty* Property, TConstArrayView<float> LevelValues);
+
+	void Write(TArray<uint8>& OutData, uint32 SourceHash = 0) const;
+
+private:
+	uint32 FindOrAddString(const FString& String);
+	uint32 FindOrAddSet(const UClass* SetClass);
+	uint32 FindOrAddProperty(uint32 SetIndex, const FProperty* Property);
+
+	TArray<FString> Strings;
+	TMap<FString, uint32> StringIndices;
+	TMap<const UClass*, uint32> SetIndices;
+	TMap<const FProperty*, uint32> PropertyIndices;
+
+	TArray<FKaosAttributeDefaultsData::FGroupEntry> Groups;
+	TArray<FKaosAttributeDefaultsData::FSetEntry> Sets;
+	TArray<FKaosAttributeDefaultsData::FPropertyEntry> Properties;
+	TArray<FKaosAttributeDefaultsData::FGroupSetEntry> GroupSets;
+	TArray<FKaosAttributeDefaultsData::FColumnEntry> Columns;
+	TArray<float> Values;
+};
@@ -21,8 +21,10 @@
 
 #include "CoreMinimal.h"
 #include "AttributeSet.h"
+#include "KaosAttributeDefaultsData.h"
 #include "GameplayEffectTypes.h"
 #include "GameplayTagContainer.h"
+#include "UObject/ObjectKey.h"
 #include "UObject/Object.h"
 #include "KaosAttributeSet.generated.h"
 
@@ -46,8 +48,43 @@ GAMEPLAYATTRIBUTE_VALUE_GETTER(PropertyName) \
 GAMEPLAYATTRIBUTE_VALUE_SETTER(PropertyName) \
 GAMEPLAYATTRIBUTE_VALUE_INITTER(PropertyName)
 
+/*
+ * How the levels between sparse curve table keys get their attribute defaults
+ */
+UENUM()
+enum class EKaosAttributeDefaultsInterpolation : uint8
+{
+	Curve UMETA(DisplayName = "Use the interpolation mode of the curve"),
+	Linear UMETA(DisplayName = "Linear between keys"),
+	Cubic UMETA(DisplayName = "Smooth cubic through keys"),
+};
+
+/*
+ * How the levels past the last curve table key get their attribute defaults.
+ * Levels from 1 up to the first key hold the first key's value unless Linear, matching how the curve tables evaluate before their first key.
+ */
+UENUM()
+enum class EKaosAttributeDefaultsExtrapolation : uint8
+{
+	None UMETA(DisplayName = "Levels past the last key are undefined, levels below the first key hold its value"),
+	Clamp UMETA(DisplayName = "Hold the value of the last key"),
+	Linear UMETA(DisplayName = "Continue the slope of the last two keys"),
+};
+
+/** A single AbilitySystemComponent to initialize as part of InitAttributeSetDefaultsBatch */
+struct FKaosAttributeSetInitRequest
+{
+	UAbilitySystemComponent* AbilitySystemComponent = nullptr;
+	FName GroupName;
+	int32 Level = 1;
+};
+
 struct KAOSGASUTILITIES_API FKaosAttributeSetInitter : public FAttributeSetInitter
 {
+	/** Curve table keys may be sparse, every level from 1 up to MaxLevel (or the last key when 0) is precomputed at preload */
+	FKaosAttributeSetInitter(EKaosAttributeDefaultsInterpolation InInterpolation = EKaosAttributeDefaultsInterpolation::Curve,
+	                         EKaosAttributeDefaultsExtrapolation InExtrapolation = EKaosAttributeDefaultsExtrapolation::None, int32 InMaxLevel = 0);
+
 	virtual void PreloadAttributeSetData(const TArray<UCurveTable*>& CurveData) override;
 
 	virtual void InitAttributeSetDefaults(UAbilitySystemComponent* AbilitySystemComponent, FName GroupName, int32 Level, bool bInitialInit) const override;
@@ -55,41 +92,93 @@ struct KAOSGASUTILITIES_API FKaosAttributeSetInitter : public FAttributeSetInitt
 
 	virtual TArray<float> GetAttributeSetValues(UClass* AttributeSetClass, FProperty* AttributeProperty, FName GroupName) const override;
 
+	/** Returns the defaults of an attribute indexed by level - 1 without copying them, falling back to the Default group like InitAttributeSetDefaults. Empty if the group does not define it */
+	TConstArrayView<float> GetAttributeSetValuesView(const UClass* AttributeSetClass, const FProperty* AttributeProperty, FName GroupName) const;
+
+	/**
+	 * Initializes the defaults of many AbilitySystemComponents at once. Attributes of a UKaosAbilitySystemComponent without an aggregator are
+	 * written directly and their value change delegates are broadcast once per changed attribute after every request has been applied.
+	 * Attributes with an aggregator go through SetNumericAttributeBase, which broadcasts straight away. Replication is forced once per component.
+	 */
+	virtual void InitAttributeSetDefaultsBatch(TConstArrayView<FKaosAttributeSetInitRequest> Requests, bool bInitialInit) const;
+
+	/** Replaces the defaults CurveTable contributed with its current rows, leaving the other tables untouched. Groups whose defaults changed are added to OutAffectedGroups. */
+	void ReloadAttributeSetData(const UCurveTable* CurveTable, TSet<FName>& OutAffectedGroups);
+
+	/** Uses a cooked defaults file (memory mapped when possible) instead of parsing curve tables, fails if it was not stamped with SourceHash */
+	bool LoadCookedDefaults(const FString& Filename, uint32 SourceHash);
+
+	/** Writes the defaults parsed from curve tables in the cooked format read by LoadCookedDefaults */
+	bool WriteCookedDefaults(const FString& Filename, uint32 SourceHash) const;
+
+	/** True when the defaults come from a cooked file, there is no per table data to reload then */
+	bool IsUsingCookedDefaults() const { return bUsingCookedDefaults; }
+
 private:
 	bool IsSupportedProperty(FProperty* Property) const;
 
-	struct FKaosAttributeDefaultValueList
+	static void GetAttributeSetClasses(TArray<TSubclassOf<UAttributeSet>>& OutClassList);
+
+	/** Parses the rows of CurTable into Defaults, tagging every value with the table it came from */
+	void PreloadCurveTable(const UCurveTable* CurTable, const TArray<TSubclassOf<UAttributeSet>>& ClassList, TSet<FName>* OutAffectedGroups);
+
+	/** Evaluates Curve at every level into OutLevelValues, index is level - 1 */
+	void EvaluateLevelValues(const FRealCurve& Curve, TArray<float>& OutLevelValues) const;
+
+	/** Rebuilds CompiledDefaults from the parsed curve table data */
+	void CompileDefaults();
+	void WriteDefaults(TArray<uint8>& OutData, uint32 SourceHash) const;
+
+	/** Returns the compiled index of GroupName, falling back to the Default group */
+	int32 FindGroupIndex(FName GroupName) const;
+
+	/** Returns the columns of Set or its closest parent class within the group */
+	const FKaosAttributeDefaultsData::FGroupSetEntry* FindGroupSet(int32 GroupIndex, const UAttributeSet* Set) const;
+
+	/** Values one table gives an attribute for every level, index is level - 1 */
+	struct FKaosAttributeDefaultContribution
 	{
-		void AddPair(FProperty* InProperty, float InValue)
-		{
-			List.Add(FKaosOffsetValuePair(InProperty, InValue));
-		}
-
-		struct FKaosOffsetValuePair
-		{
-			FKaosOffsetValuePair(FProperty* InProperty, float InValue)
-				: Property(InProperty), Value(InValue)
-			{
-			}
-
-			FProperty* Property;
-			float Value;
-		};
-
-		TArray<FKaosOffsetValuePair> List;
+		TObjectKey<UCurveTable> SourceTable;
+		TArray<float> LevelValues;
+	};
+
+	/** Values of one attribute. Every table defining it is kept so reloading one table does not change which of them wins. */
+	struct FKaosAttributeDefaultColumn
+	{
+		FProperty* Property = nullptr;
+
+		/** Ordered like the tables in TableOrder, the last one overrides the others */
+		TArray<FKaosAttributeDefaultContribution, TInlineAllocator<1>> Contributions;
+
+		const TArray<float>& GetLevelValues() const { return Contributions.Last().LevelValues; }
 	};
 
 	struct FKaosAttributeSetDefaults
 	{
-		TMap<TSubclassOf<UAttributeSet>, FKaosAttributeDefaultValueList> DataMap;
+		TArray<FKaosAttributeDefaultColumn> Columns;
 	};
 
 	struct FKaosAttributeSetDefaultsCollection
 	{
-		TArray<FKaosAttributeSetDefaults> LevelData;
+		TMap<TSubclassOf<UAttributeSet>, FKaosAttributeSetDefaults> DataMap;
 	};
 
+	/** Returns the position of CurveTable in the preload order, tables first seen on a reload go last */
+	int32 GetTableOrder(TObjectKey<UCurveTable> CurveTable);
+
+	/** Defaults parsed from curve tables, kept so single tables can be reloaded. Empty when running from cooked defaults. */
 	TMap<FName, FKaosAttributeSetDefaultsCollection> Defaults;
+
+	/** Tables in the order they were preloaded, later tables override the attributes of earlier ones */
+	TArray<TObjectKey<UCurveTable>> TableOrder;
+
+	/** What every lookup reads, compiled from Defaults or loaded from a cooked file */
+	FKaosAttributeDefaultsData CompiledDefaults;
+
+	EKaosAttributeDefaultsInterpolation Interpolation;
+	EKaosAttributeDefaultsExtrapolation Extrapolation;
+	int32 MaxLevel;
+	bool bUsingCookedDefaults = false;
 };
 
 
@@ -22,6 +22,7 @@
 
 #include "CoreMinimal.h"
 #include "AbilitySystemInterface.h"
+#include "GameplayAbilitySpec.h"
 #include "GameplayTagContainer.h"
 #include "KaosUtilitiesTypes.h"
 #include "Engine/DataAsset.h"
@@ -31,7 +32,54 @@
 class UAbilitySystemComponent;
 class UGameplayAbility;
 class UGameplayEffect;
+class UAttributeSet;
+struct FActiveGameplayEffect;
+struct FStreamableHandle;
 
+/** Called once an asynchronously granted ability set has been streamed in and granted, LoadSeconds is the time spent streaming. */
+DECLARE_DELEGATE_TwoParams(FKaosOnAbilitySetGrantedAsync, const FKaosAbilitySetHandle& /*Handle*/, double /*LoadSeconds*/);
+
+
+/**
+ * FKaosAbilitySetCompiledEffect
+ *
+ *	Gameplay effect entry of a compiled ability set.
+ */
+USTRUCT()
+struct FKaosAbilitySetCompiledEffect
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TObjectPtr<UGameplayEffect> GameplayEffect = nullptr;
+
+	UPROPERTY(Transient)
+	float EffectLevel = 1.0f;
+};
+
+/**
+ * FKaosAbilitySetCompiledGrants
+ *
+ *	The entries of an ability set resolved into ready to copy grant data. Indices match the source arrays, entries that
+ *	could not be resolved when compiling (unloaded soft references or invalid entries) are left empty and resolved on grant.
+ */
+USTRUCT()
+struct FKaosAbilitySetCompiledGrants
+{
+	GENERATED_BODY()
+
+	// Spec templates, copies get a fresh handle and the source object when granted.
+	UPROPERTY(Transient)
+	TArray<FGameplayAbilitySpec> AbilitySpecs;
+
+	UPROPERTY(Transient)
+	TArray<FKaosAbilitySetCompiledEffect> GameplayEffects;
+
+	UPROPERTY(Transient)
+	TArray<TSubclassOf<UAttributeSet>> AttributeSets;
+
+	bool bCompiled = false;
+};
 
 /**
  * 
@@ -47,11 +95,47 @@ public:
 	KAOSGASUTILITIES_API const TArray<FKaosAbilitySet_GameplayAbility>& GetGrantedGameplayAbilities() const { return GrantedGameplayAbilities; }
 	KAOSGASUTILITIES_API const TArray<FKaosAbilitySet_GameplayEffect>& GetGrantedGameplayEffects() const { return GrantedGameplayEffects; }
 
+	/**
+	 * Streams in every soft referenced class of this set and grants it once loaded. OnGranted is always called, with an invalid handle
+	 * if the grant could not happen. Returns the streamable handle, or nullptr if nothing needed loading and the set was granted immediately.
+	 * The set holds the handle until the load completes, callers only need to keep it to wait on or cancel the load.
+	 */
+	KAOSGASUTILITIES_API TSharedPtr<FStreamableHandle> GiveAbilitySetToAsync(UAbilitySystemComponent* ASC, FKaosOnAbilitySetGrantedAsync OnGranted, UObject* OverrideSourceObject = nullptr) const;
+
+	/** Gathers the soft referenced classes of this set that are not loaded yet */
+	KAOSGASUTILITIES_API void GetPendingSoftReferences(TArray<FSoftObjectPath>& OutSoftReferences) const;
+
+#if WITH_EDITOR
+	KAOSGASUTILITIES_API virtual EDataValidationResult IsDataValid(FDataValidationContext& Context) const override;
+	KAOSGASUTILITIES_API virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 protected:
 	KAOSGASUTILITIES_API virtual FKaosAbilitySetHandle GiveAbilitySetTo(UAbilitySystemComponent* ASC, UObject* OverrideSourceObject = nullptr) const;
 	KAOSGASUTILITIES_API virtual FKaosAbilitySetHandle GiveAbilitySetToInterface(TScriptInterface<IAbilitySystemInterface> AbilitySystemInterface, UObject* OverrideSourceObject = nullptr) const;
 	KAOSGASUTILITIES_API static void RemoveAllAbilitySets(UAbilitySystemComponent* ASC);
 
+	/**
+	 * Replaces the set granted through OldHandle with NewSet, only removing and granting what differs between the two.
+	 * Abilities and effects granted identically by both are carried over with their handles intact. OldHandle is reset.
+	 */
+	KAOSGASUTILITIES_API static FKaosAbilitySetHandle SwapAbilitySet(FKaosAbilitySetHandle& OldHandle, const UKaosGameplayAbilitySet* NewSet, UObject* OverrideSourceObject = nullptr);
+
+	/** Grants every ability and effect of this set to ASC except the ones flagged as skipped, adding their handles to InOutHandle */
+	void GrantToAbilitySystem(UAbilitySystemComponent* ASC, UObject* OverrideSourceObject, FKaosAbilitySetHandle& InOutHandle, const TBitArray<>& SkippedAbilities, const TBitArray<>& SkippedEffects) const;
+
+	/** Returns the index of the first unclaimed ability entry that would grant an identical spec, or INDEX_NONE */
+	int32 FindMatchingAbility(const FGameplayAbilitySpec& Spec, const UObject* SourceObject, const TBitArray<>& ClaimedAbilities) const;
+
+	/** Returns the index of the first unclaimed effect entry that would apply the same effect at the same level, or INDEX_NONE */
+	int32 FindMatchingEffect(const FActiveGameplayEffect& ActiveEffect, const TBitArray<>& ClaimedEffects) const;
+
+	/** Returns the compiled grants, compiling them on first use after load or edit */
+	const FKaosAbilitySetCompiledGrants& GetCompiledGrants() const;
+
+	/** Fills the compiled entries left empty by soft references that have been loaded since compiling */
+	void ResolveLoadedCompiledGrants() const;
+
 	// Gameplay abilities to grant when this ability set is granted.
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay Abilities", meta=(TitleProperty=Ability))
 	TArray<FKaosAbilitySet_GameplayAbility> GrantedGameplayAbilities;
@@ -64,5 +148,12 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay Effects", meta=(TitleProperty=AttributeSet))
 	TArray<FKaosAbilitySet_AttributeSet> GrantedAttributeSets;
 
+	// Entries resolved into spec templates, validation happens in IsDataValid so this is built without any checks.
+	UPROPERTY(Transient)
+	mutable FKaosAbilitySetCompiledGrants CompiledGrants;
+
+	// Loads started by GiveAbilitySetToAsync that have not completed, held so callers may discard the returned handle.
+	mutable TArray<TSharedPtr<FStreamableHandle>> PendingLoadHandles;
+
 	friend class UKaosUtilitiesBlueprintLibrary;
 };
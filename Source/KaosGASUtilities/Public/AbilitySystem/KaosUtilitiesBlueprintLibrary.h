@@ -25,6 +25,7 @@
 #include "GameplayAbilitySpec.h"
 #include "GameplayTagContainer.h"
 #include "KaosGameplayAbilitySet.h"
+#include "Containers/Ticker.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "UObject/Object.h"
 #include "KaosUtilitiesBlueprintLibrary.generated.h"
@@ -36,22 +37,110 @@ class UAbilitySystemComponent;
 /** Called when a gameplay attribute bound to an event wrapper via one of the BindEventWrapper<Attribute> methods on the AbilitySystemLibrary changes. */
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FOnKaosGameplayAttributeChangedEventWrapperSignature, const FGameplayAttribute&, Attribute, float, OldValue, float, NewValue);
 
-/** Holds tracking data for gameplay attribute changed event wrappers that have been bound. */
-struct FKaosGameplayAttributeChangedEventWrapperSpec
+/** Called when an ability set given through GiveAbilitySetToASCAsync has been streamed in and granted. */
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FKaosOnAbilitySetGrantedDynamic, const FKaosAbilitySetHandle&, AbilitySetHandle, float, LoadSeconds);
+
+/*
+ * When attribute changes are delivered to an event wrapper
+ */
+UENUM(BlueprintType)
+enum class EKaosAttributeChangedDelivery : uint8
+{
+	Immediate UMETA(DisplayName = "Every change as it happens"),
+	OncePerFrame UMETA(DisplayName = "Once per frame, coalesced per attribute"),
+	FixedRate UMETA(DisplayName = "At a fixed rate, coalesced per attribute"),
+};
+
+/**
+ * Holds tracking data for gameplay attribute changed event wrappers that have been bound.
+ * The ASC delegates a spec is bound to own it, so it keeps delivering changes until it is unbound, the ASC goes away or, for a Kaos ASC, the component is unregistered.
+ */
+struct KAOSGASUTILITIES_API FKaosGameplayAttributeChangedEventWrapperSpec : public TSharedFromThis<FKaosGameplayAttributeChangedEventWrapperSpec>
 {
+	/** Reuses a free spec from the module's pool, or allocates a spec along with its reference controller */
+	static TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> Create(
+		UAbilitySystemComponent* AbilitySystemComponent,
+		FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate,
+		EKaosAttributeChangedDelivery InDelivery = EKaosAttributeChangedDelivery::Immediate,
+		float DeliveryRateHz = 0.f);
+
 	FKaosGameplayAttributeChangedEventWrapperSpec(
 		UAbilitySystemComponent* AbilitySystemComponent,
-		FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate);
+		FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate,
+		EKaosAttributeChangedDelivery InDelivery = EKaosAttributeChangedDelivery::Immediate,
+		float DeliveryRateHz = 0.f);
 	~FKaosGameplayAttributeChangedEventWrapperSpec();
 
+	/** Binds the spec to changes of Attribute on the ASC */
+	void Bind(const FGameplayAttribute& Attribute);
+
+	/** Removes the binding to Attribute, returns false if the spec was not bound to it */
+	bool Unbind(const FGameplayAttribute& Attribute);
+
+	/** Removes every binding from the ASC and drops any queued changes */
+	void UnbindAll();
+
+	/** Bound to the ASC attribute change delegates, executes the wrapper now or queues the change for the next delivery. Releases the bindings once the wrapper's object is destroyed */
+	void HandleAttributeChanged(const FOnAttributeChangeData& ChangeData);
+
+	/** Drops any queued changes and stops the pending delivery */
+	void CancelPendingDelivery();
+
 	/** The AbilitySystemComponent this spec is bound to. */
 	TWeakObjectPtr<UAbilitySystemComponent> AbilitySystemComponentWk;
 
 	/** The event wrapper delegate cached off, to be executed when the gameplay attribute we care about changes. */
 	FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate;
 
-	/** Map of the respective gameplay attribute to the delegate handle the ASC gave us to use for unbinding later. */
-	TMap<FGameplayAttribute, FDelegateHandle> DelegateBindings;
+	struct FKaosAttributeChangedBinding
+	{
+		FGameplayAttribute Attribute;
+		FDelegateHandle DelegateHandle;
+	};
+
+	/** The bound gameplay attributes and the delegate handles the ASC gave us, most wrappers bind a handful of attributes so they are kept inline */
+	TArray<FKaosAttributeChangedBinding, TInlineAllocator<2>> DelegateBindings;
+
+private:
+	friend class FKaosGameplayAttributeChangedEventWrapperSpecPool;
+
+	/** Makes a released spec ready to be bound again */
+	void Reinitialize(UAbilitySystemComponent* AbilitySystemComponent, FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate,
+		EKaosAttributeChangedDelivery InDelivery, float DeliveryRateHz);
+
+	bool DeliverPendingChanges(float DeltaTime);
+
+	/** A change coalesced since the last delivery, the old value of the first change and the new value of the last */
+	struct FKaosPendingAttributeChange
+	{
+		FGameplayAttribute Attribute;
+		float OldValue;
+		float NewValue;
+	};
+
+	EKaosAttributeChangedDelivery Delivery;
+
+	/** Seconds between deliveries, 0 delivers on the next frame */
+	float DeliveryInterval;
+
+	TArray<FKaosPendingAttributeChange, TInlineAllocator<4>> PendingChanges;
+	FTSTicker::FDelegateHandle DeliveryTickerHandle;
+};
+
+/**
+ * Attribute changed event wrapper specs kept for reuse, widgets rebinding on every open and close would otherwise allocate a spec each time.
+ * A pooled spec is free again once the pool holds its only reference. Owned by the KaosGASUtilities module, game thread only.
+ */
+class KAOSGASUTILITIES_API FKaosGameplayAttributeChangedEventWrapperSpecPool
+{
+public:
+	TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec> Acquire(UAbilitySystemComponent* AbilitySystemComponent,
+		FOnKaosGameplayAttributeChangedEventWrapperSignature InGameplayAttributeChangedEventWrapperDelegate, EKaosAttributeChangedDelivery InDelivery, float DeliveryRateHz);
+
+private:
+	static constexpr int32 MaxPooledSpecs = 64;
+
+	TArray<TSharedRef<FKaosGameplayAttributeChangedEventWrapperSpec>> Specs;
 };
 
 /** Handle to a event wrapper listening for gameplay attribute change(s) via one of the BindEventWrapper<to attribute(s)> methods on the AbilitySystemLibrary */
@@ -62,6 +151,7 @@ struct FKaosGameplayAttributeChangedEventWrapperSpecHandle
 
 	FKaosGameplayAttributeChangedEventWrapperSpecHandle();
 	FKaosGameplayAttributeChangedEventWrapperSpecHandle(FKaosGameplayAttributeChangedEventWrapperSpec* DataPtr);
+	FKaosGameplayAttributeChangedEventWrapperSpecHandle(TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec> InData);
 
 	/** Internal pointer to binding spec */
 	TSharedPtr<FKaosGameplayAttributeChangedEventWrapperSpec>	Data;
@@ -153,7 +243,7 @@ public:
 	 * Returns true if we can apply attribute modifies for a specific Effect Spec.
 	 */
 	UFUNCTION(BlueprintCallable, Category="KaosGAS")
-	static bool CanApplyAttributeModifiers(UAbilitySystemComponent* AbilitySystemComponent, FGameplayEffectSpec EffectSpec);
+	static bool CanApplyAttributeModifiers(UAbilitySystemComponent* AbilitySystemComponent, const FGameplayEffectSpec& EffectSpec);
 
 	/**
 	 * Will block abilities with the supplied tags
@@ -185,19 +275,33 @@ public:
 	UFUNCTION(BlueprintCallable, Category="KaosGAS")
 	static FKaosAbilitySetHandle GiveAbilitySetToInterface(TScriptInterface<IAbilitySystemInterface> AbilitySystemInterface, UKaosGameplayAbilitySet* Set, UObject* OptionalOverrideSourceObject = nullptr);
 
+	/**
+	 * Streams in the soft referenced classes of the ability set and gives it to the ASC once loaded.
+	 * OnGranted receives the handle and the time spent loading in seconds. The set keeps the load alive until it completes.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="KaosGAS")
+	static void GiveAbilitySetToASCAsync(UAbilitySystemComponent* AbilitySystemComponent, UKaosGameplayAbilitySet* Set, FKaosOnAbilitySetGrantedDynamic OnGranted, UObject* OptionalOverrideSourceObject = nullptr);
+
 	/**
 	 * Will unblock abilities with the supplied tags. (will affect Gameplay Ability blocking tags!)
 	 */
 	UFUNCTION(BlueprintCallable, Category="KaosGAS")
 	static void TakeAbilitySet(UPARAM(ref) FKaosAbilitySetHandle& AbilitySetHandle);
 
+	/**
+	 * Replaces the ability set granted through AbilitySetHandle with NewSet, only granting and removing what differs between them.
+	 * Shared abilities and effects keep their handles. Returns the handle of the new set, the old handle is invalidated.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="KaosGAS")
+	static FKaosAbilitySetHandle SwapAbilitySet(UPARAM(ref) FKaosAbilitySetHandle& AbilitySetHandle, UKaosGameplayAbilitySet* NewSet, UObject* OptionalOverrideSourceObject = nullptr);
+
 	//Removes all Ability sets, but does not invalidate any handles.
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=AbilitySet)
 	static void RemoveAllAbilitySetsFromInterface(TScriptInterface<IAbilitySystemInterface> AbilitySystemInterface);
 
 	/*
 	 * Removes all Ability sets, but does not invalidate any handles.
-	 * Does NOT remove any attribute sets. Infact Attribute Set removal is not allowed with Set removals.
+	 * Only removes attribute sets flagged with bReleaseWithAbilitySet, Kaos ASCs keep those pooled for reuse.
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=AbilitySet)
 	static void RemoveAllAbilitySets(UAbilitySystemComponent* ASC);
@@ -250,14 +354,18 @@ public:
 	 * @param AbilitySystemComponent                     AbilitySystemComponent owning the Event
 	 * @param GameplayAttributeChangedEventWrapperDelegate Attribute Changed Event to trigger
 	 * @param bExecuteForCurrentValueImmediately   If true, the bound event will immediately execute if we already have the tag.
+	 * @param Delivery                           Deliver every change, or one coalesced (first old, last new) change per frame or per DeliveryRateHz
+	 * @param DeliveryRateHz                     Deliveries per second when Delivery is FixedRate
 	 * @return                                  FKaosGameplayAttributeChangedEventWrapperSpecHandle Handle by which this binding request can be unbound.
 	 */
-	UFUNCTION(BlueprintCallable, Category = "Ability|Attribute")
+	UFUNCTION(BlueprintCallable, Category = "Ability|Attribute", meta = (AdvancedDisplay = "Delivery,DeliveryRateHz"))
 	static FKaosGameplayAttributeChangedEventWrapperSpecHandle BindEventWrapperToAttributeChangedKaos(
 		UAbilitySystemComponent* AbilitySystemComponent,
 		FGameplayAttribute Attribute, 
 		FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate, 
-		bool bExecuteForCurrentValueImmediately = true);
+		bool bExecuteForCurrentValueImmediately = true,
+		EKaosAttributeChangedDelivery Delivery = EKaosAttributeChangedDelivery::Immediate,
+		float DeliveryRateHz = 10.f);
 
 	/**
 	 * Binds to changes in the given Attributes on the given ASC's attribute sets.
@@ -266,14 +374,18 @@ public:
 	 * @param AbilitySystemComponent                     AbilitySystemComponent owning the Event
 	 * @param GameplayAttributeChangedEventWrapperDelegate Attribute Changed Event to trigger
 	 * @param bExecuteForCurrentValueImmediately   If true, we fire the delegate immediately with the current value of the attribute.
+	 * @param Delivery                           Deliver every change, or one coalesced (first old, last new) change per attribute per frame or per DeliveryRateHz
+	 * @param DeliveryRateHz                     Deliveries per second when Delivery is FixedRate
 	 * @return                                  FKaosGameplayAttributeChangedEventWrapperSpecHandle Handle by which this binding request can be unbound.
 	 */
-	UFUNCTION(BlueprintCallable, Category = "Ability|Attribute")
+	UFUNCTION(BlueprintCallable, Category = "Ability|Attribute", meta = (AdvancedDisplay = "Delivery,DeliveryRateHz"))
 	static FKaosGameplayAttributeChangedEventWrapperSpecHandle BindEventWrapperToAnyOfGameplayAttributesChangedKaos(
 		UAbilitySystemComponent* AbilitySystemComponent,
 		const TArray<FGameplayAttribute>& Attributes,
 		FOnKaosGameplayAttributeChangedEventWrapperSignature GameplayAttributeChangedEventWrapperDelegate, 
-		bool bExecuteForCurrentValueImmediately = true);
+		bool bExecuteForCurrentValueImmediately = true,
+		EKaosAttributeChangedDelivery Delivery = EKaosAttributeChangedDelivery::Immediate,
+		float DeliveryRateHz = 10.f);
 
 	/**
 	 * Unbinds the event wrapper attribute change event bound via a BindEventWrapper<to gameplay attribute(s)> method that is tied to the given Handle.
@@ -0,0 +1,51 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+class AActor;
+class UAbilitySystemComponent;
+
+/**
+ * Frame scoped cache of the ability system lookups the Kaos behaviour tree nodes make, so several nodes of one tree querying the
+ * same actor in a frame resolve its ability system component and walk its ability specs once. Results are dropped at the start of
+ * every frame, and within a frame whenever the ability system component changes its tags, activates or ends an ability, changes an
+ * attribute the cost of a queried ability modifies, or for UKaosAbilitySystemComponent grants or removes one. Game thread only.
+ */
+class KAOSGASUTILITIES_API FKaosBTAbilitySystemQueryCache
+{
+public:
+	/** Ability system component of Actor, resolved once per frame */
+	static UAbilitySystemComponent* FindAbilitySystemComponent(const AActor* Actor);
+
+	/** Whether an activatable ability has AbilityTag in its asset tags */
+	static bool HasAbilityWithTag(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag);
+
+	/** Whether the first activatable ability with AbilityTag could be activated */
+	static bool CanActivateAbilityWithTag(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag);
+
+	/** Whether any ability with AbilityTag is currently active */
+	static bool IsAbilityWithTagActive(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag);
+
+	/** Whether the owner has any of the cooldown tags of the abilities with AbilityTag */
+	static bool IsAbilityWithTagOnCooldown(UAbilitySystemComponent& AbilitySystemComponent, FGameplayTag AbilityTag);
+};
@@ -26,8 +26,16 @@
 
 #include "KaosBTDecorator_CanActivateAbility.generated.h"
 
+class UAbilitySystemComponent;
+class UGameplayAbility;
+struct FGameplayAbilitySpec;
+struct FGameplayAbilitySpecHandle;
+struct FOnAttributeChangeData;
+
 /**
- * Checks to see if we can activate an ability with the supplied ability tag
+ * Checks to see if we can activate an ability with the supplied ability tag.
+ * While relevant on a Kaos ASC the result is cached and only recomputed when abilities are granted or removed, tags or ability block
+ * tags change or a cost attribute changes, requesting a flow abort when it flips.
  */
 UCLASS(MinimalAPI)
 class UKaosBTDecorator_CanActivateAbility : public UBTDecorator
@@ -39,8 +47,28 @@ public:
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
 	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
 	virtual FString GetStaticDescription() const override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/** Returns the first granted spec matching AbilityTag, skipping ExcludedHandle */
+	const FGameplayAbilitySpec* FindMatchingSpec(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayAbilitySpecHandle& ExcludedHandle) const;
+
+	bool CanActivateSpec(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayAbilitySpec* Spec) const;
+
+	/** Recomputes the cached result, resolving the spec and its cost attributes again if asked to, and requests a flow abort when it changed */
+	void RefreshCachedResult(TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory, bool bResolveSpec, const FGameplayAbilitySpecHandle& ExcludedHandle);
+
+	/** Callbacks for the events that can change whether the ability can be activated */
+	void OnAbilitySpecChanged(const FGameplayAbilitySpec& AbilitySpec, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory, bool bRemoved);
+	void OnAbilityBlockTagsChanged(TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory);
+	void OnGameplayTagChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory);
+	void OnCostAttributeChanged(const FOnAttributeChangeData& ChangeData, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory);
+
 	/** Actor for ability activation (normally self) */
 	UPROPERTY(EditAnywhere, Category=CanActivateAbility, Meta=(ToolTips="Which Actor (from the blackboard) should be checked for this gameplay tag query?"))
 	FBlackboardKeySelector ActorForAbilityActivation;
@@ -22,6 +22,7 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/BTDecorator.h"
+#include "BehaviorTree/BlackboardComponent.h"
 #include "GameplayTagContainer.h"
 #include "KaosBTDecorator_GameplayTag.generated.h"
 
@@ -93,9 +94,21 @@ protected:
 
 	bool MatchContainer(const FGameplayTagContainer& SelectedGameplayTags) const;
 
+	/** Matches the tag or container against the selected actor's tags */
+	bool MatchTags(const FGameplayTagContainer& SelectedGameplayTags) const;
+
 	/** Callback for when a tag is updated (added/removed) */
 	void OnGameplayTagsChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory);
 
+	/** Callback for when the actor key changes, moves the tag events to the new actor's ASC */
+	EBlackboardNotificationResult OnBlackboardKeyValueChange(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKeyID);
+
+	/** Caches the selected actor's ASC and registers the tag events on it */
+	void BindGameplayTagEvents(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, const AActor* SelectedActor);
+
+	/** Removes the tag events from the cached ASC and clears the cached result */
+	void UnbindGameplayTagEvents(uint8* NodeMemory) const;
+
 
 	/** called when execution flow controller becomes active */
 	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
@@ -22,6 +22,7 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/BTDecorator.h"
+#include "BehaviorTree/BlackboardComponent.h"
 #include "GameplayTagContainer.h"
 #include "KaosBTDecorator_GameplayTagQuery.generated.h"
 
@@ -57,6 +58,15 @@ protected:
 	UPROPERTY()
 	TArray<FGameplayTag> QueryTags;
 
+	/** Callback for when the actor key changes, moves the tag events to the new actor's ASC */
+	EBlackboardNotificationResult OnBlackboardKeyValueChange(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKeyID);
+
+	/** Caches the selected actor's ASC and registers the query tag events on it */
+	void BindGameplayTagEvents(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, const AActor* SelectedActor);
+
+	/** Removes the tag events from the cached ASC and clears the cached result */
+	void UnbindGameplayTagEvents(uint8* NodeMemory) const;
+
 	/** called when execution flow controller becomes active */
 	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 
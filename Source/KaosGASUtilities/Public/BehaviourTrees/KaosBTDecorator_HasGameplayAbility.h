@@ -25,8 +25,13 @@
 #include "GameplayTagContainer.h"
 #include "KaosBTDecorator_HasGameplayAbility.generated.h"
 
+class UAbilitySystemComponent;
+struct FGameplayAbilitySpec;
+struct FGameplayAbilitySpecHandle;
+
 /**
- * Check if we have an ability with the supplied AbilityTag
+ * Check if we have an ability with the supplied AbilityTag.
+ * While relevant on a Kaos ASC the result is cached, updated from ability granted and removed events and a flow abort is requested when it flips.
  */
 UCLASS(MinimalAPI)
 class UKaosBTDecorator_HasGameplayAbility : public UBTDecorator
@@ -38,8 +43,20 @@ public:
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
 	virtual FString GetStaticDescription() const override;
 	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/** Returns true if a granted spec other than ExcludedHandle matches AbilityTag */
+	bool HasMatchingSpec(const UAbilitySystemComponent& AbilitySystemComponent, const FGameplayAbilitySpecHandle& ExcludedHandle) const;
+
+	/** Callback for when an ability is granted or removed */
+	void OnAbilitySpecChanged(const FGameplayAbilitySpec& AbilitySpec, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory, bool bRemoved);
+
 	/** Target we want to check if we have ability on (normally self) */
 	UPROPERTY(EditAnywhere, Category=HasGameplayAbility)
 	FBlackboardKeySelector TargetActorKey;
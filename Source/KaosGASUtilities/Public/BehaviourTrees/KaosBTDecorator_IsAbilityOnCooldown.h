@@ -26,8 +26,11 @@
 #include "UObject/Object.h"
 #include "KaosBTDecorator_IsAbilityOnCooldown.generated.h"
 
+class UAbilitySystemComponent;
+
 /**
- * Check to see if an ability is on cooldown with the supplied AbilityTag
+ * Check to see if an ability is on cooldown with the supplied AbilityTag.
+ * While relevant the cooldown tags are watched, so the result is cached and flow aborts are requested when the cooldown starts or ends.
  */
 UCLASS(MinimalAPI)
 class UKaosBTDecorator_IsAbilityOnCooldown : public UBTDecorator
@@ -39,8 +42,20 @@ public:
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
 	virtual FString GetStaticDescription() const override;
 	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/** Gathers the cooldown tags of every ability granted to the ASC that matches AbilityTag */
+	void GatherCooldownTags(const UAbilitySystemComponent& AbilitySystemComponent, FGameplayTagContainer& OutCooldownTags) const;
+
+	/** Callback for when one of the cooldown tags is added or removed */
+	void OnCooldownTagChanged(const FGameplayTag InTag, int32 NewCount, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent, uint8* NodeMemory);
+
 	/** Target we want to check if we have ability on (normally self) */
 	UPROPERTY(EditAnywhere, Category=HasGameplayAbility)
 	FBlackboardKeySelector TargetActorKey;
@@ -22,11 +22,18 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/BTDecorator.h"
+#include "BehaviorTree/BlackboardComponent.h"
 #include "UObject/Object.h"
 #include "KaosBTDecorator_IsInRange.generated.h"
 
 /**
- * 
+ * Checks if the source and target actors are within Range of each other.
+ * While relevant the pair is registered with UKaosRangeCheckSubsystem, which spreads the distance checks across frames and only
+ * requests a flow abort when the pair crosses the range, instead of the decorator ticking.
+ *
+ * The condition is the subsystem's cached result, not the current distance. It can be up to MaxCheckInterval (or MaxStaleness) old,
+ * older when the subsystem is saturated by MaxChecksPerFrame, and it is biased by Hysteresis once in range. Actors moving faster than
+ * MaxClosingSpeed can cross the range unnoticed until the next check, teleports need UKaosRangeCheckSubsystem::NotifyActorTeleported.
  */
 UCLASS()
 class KAOSGASUTILITIES_API UKaosBTDecorator_IsInRange : public UBTDecorator
@@ -35,18 +42,35 @@ class KAOSGASUTILITIES_API UKaosBTDecorator_IsInRange : public UBTDecorator
 
 public:
 	UKaosBTDecorator_IsInRange();
-	virtual void PostLoad() override;
 	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 	virtual FString GetStaticDescription() const override;
 	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
 	bool InternalCalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const;
-	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
-	bool GetShouldAbort(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const;
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
 
 protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	/** Callback for when the range check crosses the range */
+	void OnRangeChanged(bool bInRange, TWeakObjectPtr<UBehaviorTreeComponent> BehaviorTreeComponent);
+
+	/** Callback for when the source or target actor key changes */
+	EBlackboardNotificationResult OnBlackboardKeyValueChange(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKeyID);
+
 	UPROPERTY(EditAnywhere, Category=Range)
 	float Range;
 
+	/** Extra distance beyond Range before a pair in range counts as out of range, stops aborts flickering at the boundary. 0 keeps the plain Range check */
+	UPROPERTY(EditAnywhere, Category=Range, meta=(ClampMin="0.0"))
+	float Hysteresis = 0.f;
+
+	/** Longest time in seconds the cached result may go without being evaluated again, 0 uses the subsystem's MaxCheckInterval */
+	UPROPERTY(EditAnywhere, Category=Range, meta=(ClampMin="0.0", Units="s"))
+	float MaxStaleness = 0.f;
+
 	UPROPERTY(EditAnywhere, Category=Range)
 	FBlackboardKeySelector SourceActorKey;
 
@@ -0,0 +1,60 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTService.h"
+#include "BehaviourTrees/KaosBTTickSchedulerSubsystem.h"
+#include "KaosBTService.generated.h"
+
+/** Node memory of UKaosBTService, derived services derive their node memory from it */
+struct FKaosBTServiceMemory
+{
+	FKaosBTTickSchedulerHandle TickSchedulerHandle;
+};
+
+/**
+ * Base of the periodic Kaos services.
+ * With bUseTickScheduler set, TickNode is run by UKaosBTTickSchedulerSubsystem within its per frame budget instead of by the tree,
+ * still about every Interval seconds give or take RandomDeviation.
+ */
+UCLASS(Abstract)
+class KAOSGASUTILITIES_API UKaosBTService : public UBTService
+{
+	GENERATED_BODY()
+
+public:
+	UKaosBTService();
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+
+protected:
+	/** Tick through UKaosBTTickSchedulerSubsystem, sharing a per frame budget with the other agents, instead of on the service interval */
+	UPROPERTY(EditAnywhere, Category=Service)
+	bool bUseTickScheduler = false;
+
+private:
+	/** Tick run by UKaosBTTickSchedulerSubsystem when bUseTickScheduler is set */
+	void OnScheduledTick(float DeltaSeconds, TWeakObjectPtr<UBehaviorTreeComponent> OwnerComp, uint8* NodeMemory);
+};
@@ -21,10 +21,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "BehaviorTree/BTService.h"
+#include "BehaviourTrees/KaosBTService.h"
 #include "GameplayTagContainer.h"
 #include "KaosBTService_ActivateAbilityByTag.generated.h"
 
+class UAbilitySystemComponent;
+class UGameplayAbility;
+struct FKaosBTService_ActivateAbilityByTagMemory;
+
 /*
  * Behaviour to do when the Behaviour Service ceases relevance
  */
@@ -39,15 +43,19 @@ enum class EKaosActivateAbilityByTagOnCeaseRelevanceBehaviour : uint8
  * Try to always run and activate ability with the supplied GameplayTag.
  */
 UCLASS(MinimalAPI)
-class UKaosBTService_ActivateAbilityByTag : public UBTService
+class UKaosBTService_ActivateAbilityByTag : public UKaosBTService
 {
 	GENERATED_BODY()
 
 public:
 	UKaosBTService_ActivateAbilityByTag();
 	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual FString GetStaticDescription() const override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 protected:
 	/** Ability to activate */
@@ -61,4 +69,30 @@ protected:
 	/** What to do when service becomes non relevant */
 	UPROPERTY(EditAnywhere, Category=ActivateAbilityByTag)
 	EKaosActivateAbilityByTagOnCeaseRelevanceBehaviour NodeCeaseRelevanceBehaviour = EKaosActivateAbilityByTagOnCeaseRelevanceBehaviour::Nothing;
+
+	/** Only retry activation after an ability ended or a gameplay tag or ability block tag changed, instead of on every tick */
+	UPROPERTY(EditAnywhere, Category=ActivateAbilityByTag)
+	bool bEventDriven = false;
+
+	/** In event driven mode, also retry after this many seconds without events, covering failures no event reports such as costs. 0 only retries on events */
+	UPROPERTY(EditAnywhere, Category=ActivateAbilityByTag, meta=(EditCondition="bEventDriven", ClampMin="0.0", Units="s"))
+	float EventDrivenRetryInterval = 0.f;
+
+	/** Tries to activate the cached ability specs if an event said it could now succeed, following the target blackboard key to its current ASC */
+	void TickEventDriven(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory);
+
+	/** Binds the activation condition callbacks to AbilitySystemComponent, used in event driven mode */
+	void BindActivationEvents(UAbilitySystemComponent& AbilitySystemComponent, uint8* NodeMemory);
+
+	/** Unbinds the activation condition callbacks from the cached ASC */
+	void UnbindActivationEvents(FKaosBTService_ActivateAbilityByTagMemory& MyMemory) const;
+
+	/** Caches the handles of the specs matching AbilityToActivate */
+	void CacheAbilitySpecHandles(UAbilitySystemComponent& AbilitySystemComponent, FKaosBTService_ActivateAbilityByTagMemory& MyMemory) const;
+
+	/** Activation condition callbacks, used in event driven mode */
+	void OnAbilityEnded(UGameplayAbility* Ability, uint8* NodeMemory);
+	void OnGameplayTagChanged(const FGameplayTag InTag, int32 NewCount, uint8* NodeMemory);
+	void OnAbilityBlockTagsChanged(uint8* NodeMemory);
+	void OnAbilitySpecChanged(const FGameplayAbilitySpec& AbilitySpec, uint8* NodeMemory);
 };
@@ -22,11 +22,13 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/BTService.h"
+#include "GameplayEffectTypes.h"
 #include "GameplayTagContainer.h"
 #include "KaosBTService_GameplayEffect.generated.h"
 
 class UGameplayEffect;
 class UAbilitySystemComponent;
+struct FKaosBTService_GameplayEffectMemory;
 
 /*
  * Behaviour to do when the Behaviour Service Activates/Deactivates
@@ -53,11 +55,17 @@ public:
 	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual FString GetStaticDescription() const override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 protected:
-	void ApplyGameplayEffect(UBehaviorTreeComponent& OwnerComp, bool bFromDeactivation);
+	void ApplyGameplayEffect(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, bool bFromDeactivation);
 	void RemoveGameplayEffect(UBehaviorTreeComponent& OwnerComp, bool bFromDeactivation);
-	bool CheckGameplayTagQuery(UAbilitySystemComponent* ASC, const FGameplayTagQuery& Query);
+	bool CheckGameplayTagQuery(const UAbilitySystemComponent& ASC, const FGameplayTagQuery& Query) const;
+
+	/** Returns the owner's outgoing spec of GameplayEffect at Level, built once and kept in node memory */
+	FGameplayEffectSpecHandle FindOrMakeOutgoingSpec(UAbilitySystemComponent& OwnerASC, FKaosBTService_GameplayEffectMemory& MyMemory, TSubclassOf<UGameplayEffect> GameplayEffect, float Level) const;
 
 	/** What to do when this service activates (becomes relevant) */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Activation")
@@ -67,6 +75,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Activation", meta = (EditCondition = "ActivationBehaviour != EKaosBTServiceGameplayEffectBehaviour::None"))
 	TSubclassOf<UGameplayEffect> ActivationGameplayEffect;
 
+	/** Level the Activation GameplayEffect is applied at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Activation", meta = (EditCondition = "ActivationBehaviour == EKaosBTServiceGameplayEffectBehaviour::Apply"))
+	float ActivationEffectLevel = 1.f;
+
 	/** The target of the applied/removed Effect. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Activation", meta = (EditCondition = "ActivationBehaviour != EKaosBTServiceGameplayEffectBehaviour::None"))
 	FBlackboardKeySelector ActivationEffectTargetBlackboardKey;
@@ -91,6 +103,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Deactivation", meta = (EditCondition = "DeactivationBehaviour != EKaosBTServiceGameplayEffectBehaviour::None"))
 	TSubclassOf<UGameplayEffect> DeactivationGameplayEffect;
 
+	/** Level the Deactivation GameplayEffect is applied at */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Deactivation", meta = (EditCondition = "DeactivationBehaviour == EKaosBTServiceGameplayEffectBehaviour::Apply"))
+	float DeactivationEffectLevel = 1.f;
+
 	/** The target of the applied/removed Effect. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GameplayEffect|Deactivation", meta = (EditCondition = "DeactivationBehaviour != EKaosBTServiceGameplayEffectBehaviour::None"))
 	FBlackboardKeySelector DeactivationEffectTargetBlackboardKey;
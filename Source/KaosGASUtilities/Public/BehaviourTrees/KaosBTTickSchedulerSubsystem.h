@@ -0,0 +1,121 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "KaosBTTickSchedulerSubsystem.generated.h"
+
+class UBehaviorTreeComponent;
+
+DECLARE_DELEGATE_OneParam(FKaosScheduledBTTick, float /*DeltaSeconds*/);
+
+/** Handle to an evaluation registered with UKaosBTTickSchedulerSubsystem */
+struct FKaosBTTickSchedulerHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Serial = 0; }
+};
+
+/** Counters of the last frame and totals since the world started */
+struct FKaosBTTickSchedulerStats
+{
+	int32 NumRegistered = 0;
+	int32 NumDueLastFrame = 0;
+	int32 NumEvaluatedLastFrame = 0;
+
+	/** Due evaluations pushed to the next frame by the budget */
+	int32 NumDeferredLastFrame = 0;
+	double LastFrameMilliseconds = 0.0;
+
+	/** Longest an evaluation was overdue when it finally ran */
+	double MaxOverdueSeconds = 0.0;
+
+	uint64 TotalEvaluations = 0;
+	uint64 TotalDeferred = 0;
+};
+
+/**
+ * Runs the periodic evaluations of Kaos behaviour tree nodes within a per frame millisecond budget, instead of every node ticking
+ * on its own interval. Evaluations start at a random point of their interval so they do not line up. Due evaluations are run in
+ * order of how overdue they are, scaled up for agents close to a player, and whatever does not fit the budget is deferred.
+ */
+UCLASS(config=Game)
+class KAOSGASUTILITIES_API UKaosBTTickSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UKaosBTTickSchedulerSubsystem* Get(const UWorld* World);
+
+	/** Registers an evaluation of a node for the agent of OwnerComp, run about every Interval seconds give or take a random RandomDeviation */
+	FKaosBTTickSchedulerHandle RegisterEvaluation(const UBehaviorTreeComponent& OwnerComp, float Interval, float RandomDeviation, FKaosScheduledBTTick Evaluation);
+
+	void UnregisterEvaluation(FKaosBTTickSchedulerHandle& Handle);
+
+	const FKaosBTTickSchedulerStats& GetStats() const { return Stats; }
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Time the scheduled evaluations may take each frame */
+	UPROPERTY(config)
+	float FrameBudgetMilliseconds = 0.5f;
+
+	/** Evaluations always run each frame however long they take, so nothing is starved by a single slow evaluation */
+	UPROPERTY(config)
+	int32 MinEvaluationsPerFrame = 1;
+
+	/** Agents this close to a player have their priority doubled, falling off with distance beyond it */
+	UPROPERTY(config)
+	float PriorityDistance = 2000.f;
+
+private:
+	struct FKaosScheduledEvaluation
+	{
+		TWeakObjectPtr<const AActor> Agent;
+		FKaosScheduledBTTick Evaluation;
+		float Interval = 0.f;
+		float RandomDeviation = 0.f;
+		double NextDueTime = 0.0;
+		double LastRunTime = 0.0;
+		uint32 Serial = 0;
+	};
+
+	/** Priority multiplier from the agent's distance to the closest player */
+	float GetRelevancy(const AActor* Agent, TConstArrayView<FVector> PlayerLocations) const;
+
+	/** Seconds until the evaluation is next due, its interval with a new random deviation */
+	static float GetNextInterval(const FKaosScheduledEvaluation& ScheduledEvaluation);
+
+	TSparseArray<FKaosScheduledEvaluation> Evaluations;
+
+	/** Priority and handle of the evaluations due this frame, kept to reuse its allocation */
+	TArray<TPair<float, FKaosBTTickSchedulerHandle>> DueEvaluations;
+	FKaosBTTickSchedulerStats Stats;
+	uint32 NextSerial = 1;
+};
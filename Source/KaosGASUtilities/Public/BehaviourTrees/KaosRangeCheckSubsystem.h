@@ -0,0 +1,115 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "KaosRangeCheckSubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FKaosOnRangeCheckChanged, bool /*bInRange*/);
+
+/** Handle to a range check registered with UKaosRangeCheckSubsystem */
+struct FKaosRangeCheckHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Serial = 0; }
+};
+
+/**
+ * Shared distance checks between pairs of actors. Checks are spread across frames with a per frame limit, and each pair is scheduled
+ * from how far it is from its threshold, so pairs well inside or outside of range are rarely evaluated. A pair enters range at Range
+ * and only leaves it beyond Range + Hysteresis, the change delegate only fires when a pair crosses.
+ */
+UCLASS(config=Game)
+class KAOSGASUTILITIES_API UKaosRangeCheckSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UKaosRangeCheckSubsystem* Get(const UWorld* World);
+
+	/**
+	 * Registers a range check between two actors, it is evaluated immediately so IsInRange is valid straight away.
+	 * MaxStaleness caps the time between evaluations of this check below MaxCheckInterval, 0 uses MaxCheckInterval.
+	 */
+	FKaosRangeCheckHandle RegisterRangeCheck(const AActor* SourceActor, const AActor* TargetActor, float Range, float Hysteresis, FKaosOnRangeCheckChanged OnChanged, float MaxStaleness = 0.f);
+
+	void UnregisterRangeCheck(FKaosRangeCheckHandle& Handle);
+
+	/** Swaps the actors of a range check and evaluates it, firing its delegate if the result changed */
+	void SetRangeCheckActors(const FKaosRangeCheckHandle& Handle, const AActor* SourceActor, const AActor* TargetActor);
+
+	/** Last evaluated result of the range check, false for an invalid handle */
+	bool IsInRange(const FKaosRangeCheckHandle& Handle) const;
+
+	/** Evaluates every range check involving Actor now, firing the delegates of those that changed. Call it when an actor teleports, the schedule assumes MaxClosingSpeed */
+	void NotifyActorTeleported(const AActor* Actor);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Most range checks evaluated in a single frame, due checks beyond it wait for the next frame */
+	UPROPERTY(config)
+	int32 MaxChecksPerFrame = 64;
+
+	/** Fastest two actors are expected to close or open the distance between them, in cm/s. Sets how long a pair can wait before being checked again */
+	UPROPERTY(config)
+	float MaxClosingSpeed = 1500.f;
+
+	/** Shortest time in seconds between evaluations of a pair, 0 lets a pair right at its threshold be checked every frame */
+	UPROPERTY(config)
+	float MinCheckInterval = 0.f;
+
+	/** Longest time in seconds between evaluations of a pair, however far it is from its threshold */
+	UPROPERTY(config)
+	float MaxCheckInterval = 1.f;
+
+private:
+	struct FKaosRangeCheck
+	{
+		TWeakObjectPtr<const AActor> SourceActor;
+		TWeakObjectPtr<const AActor> TargetActor;
+		float Range = 0.f;
+		float ExitRange = 0.f;
+		float MaxStaleness = 0.f;
+		double NextCheckTime = 0.0;
+		uint32 Serial = 0;
+		bool bInRange = false;
+		FKaosOnRangeCheckChanged OnChanged;
+	};
+
+	const FKaosRangeCheck* FindRangeCheck(const FKaosRangeCheckHandle& Handle) const;
+
+	/** Evaluates the range check and schedules its next evaluation, returns true if the result changed */
+	bool EvaluateRangeCheck(FKaosRangeCheck& RangeCheck, double CurrentTime) const;
+
+	TSparseArray<FKaosRangeCheck> RangeChecks;
+
+	/** Where the next frame starts looking for due checks, so a full budget does not starve the checks at the end */
+	int32 NextCheckIndex = 0;
+	uint32 NextSerial = 1;
+};
@@ -170,6 +170,26 @@ class KAOSGASUTILITIES_API UKaosAIBlueprintFunctionLibrary : public UBlueprintFu
 	UFUNCTION(BlueprintPure, Category = "Perception", meta = (DisplayName = "Is Friendly or Neutral"))
 	static bool IsFriendlyOrNeutralInterface(TScriptInterface<IGenericTeamAgentInterface> ActorA, TScriptInterface<IGenericTeamAgentInterface> ActorB);
 
+	/**
+	 * @brief Filters actors by the attitude of an actor towards them, resolving each actor's team once
+	 * @param Source Actor whose attitude is tested
+	 * @param Candidates Actors to filter
+	 * @param Attitude Attitude the returned actors must have from Source
+	 * @return Candidates Source has Attitude towards, in their original order
+	 */
+	UFUNCTION(BlueprintPure, Category = "Perception", meta = (DisplayName = "Filter Actors By Attitude"))
+	static TArray<AActor*> FilterActorsByAttitude(const AActor* Source, const TArray<AActor*>& Candidates, TEnumAsByte<ETeamAttitude::Type> Attitude);
+
+public:
+	/** Writes the team id of each actor, FGenericTeamId::NoTeam for actors without a team agent interface */
+	static void GetTeamIds(TConstArrayView<AActor*> Actors, TArray<uint8>& OutTeamIds);
+
+	/** Sets the bit of each candidate Source has Attitude towards, so one source can be tested against many candidates in a batch */
+	static void GetAttitudeMask(const AActor* Source, TConstArrayView<AActor*> Candidates, ETeamAttitude::Type Attitude, TBitArray<>& OutMask);
+
+	/** GetAttitudeMask for team ids gathered with GetTeamIds, letting several sources reuse the candidates' ids */
+	static void GetAttitudeMaskFromTeamIds(FGenericTeamId SourceTeamId, TConstArrayView<uint8> CandidateTeamIds, ETeamAttitude::Type Attitude, TBitArray<>& OutMask);
+
 
 	/**
 	 * @brief Get the navigation system for the given world context object.
@@ -1,4 +1,4 @@
-// Copyright (C) 2024, Daniel Moss
+﻿// Copyright (C) 2024, Daniel Moss
 // 
 // Permission is hereby granted, free of charge, to any person obtaining a
 // copy of this software and associated documentation files (the "Software"),
@@ -23,10 +23,18 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+class FKaosGameplayAttributeChangedEventWrapperSpecPool;
+
 class FKaosGASUtilitiesModule : public IModuleInterface
 {
 public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	/** Pool of attribute changed event wrapper specs, null while the module is not started */
+	static FKaosGameplayAttributeChangedEventWrapperSpecPool* GetEventWrapperSpecPool() { return EventWrapperSpecPool; }
+
+private:
+	static FKaosGameplayAttributeChangedEventWrapperSpecPool* EventWrapperSpecPool;
 };
@@ -44,10 +44,23 @@ struct FKaosAbilitySet_GameplayAbility
 	GENERATED_BODY()
 
 public:
+	/** Returns the ability class to grant, nullptr if it only has a soft reference that is not loaded yet */
+	TSubclassOf<UGameplayAbility> GetAbilityClass() const;
+
+	/** Returns the ability class to grant, synchronously loading the soft reference if needed */
+	TSubclassOf<UGameplayAbility> LoadAbilityClass() const;
+
+	/** Returns the path of the ability class to grant, valid whether or not the soft reference is loaded */
+	FSoftObjectPath GetAbilityClassPath() const;
+
 	// Gameplay ability to grant.
 	UPROPERTY(EditDefaultsOnly, Category=Ability)
 	TSubclassOf<UGameplayAbility> Ability = nullptr;
 
+	// Gameplay ability to grant, only loaded when the set is granted. Ignored when Ability is set.
+	UPROPERTY(EditDefaultsOnly, Category=Ability)
+	TSoftClassPtr<UGameplayAbility> SoftAbility;
+
 	// Level of ability to grant.
 	UPROPERTY(EditDefaultsOnly, Category=Ability)
 	int32 AbilityLevel = 1;
@@ -69,10 +82,23 @@ struct FKaosAbilitySet_GameplayEffect
 	GENERATED_BODY()
 
 public:
+	/** Returns the effect class to grant, nullptr if it only has a soft reference that is not loaded yet */
+	TSubclassOf<UGameplayEffect> GetGameplayEffectClass() const;
+
+	/** Returns the effect class to grant, synchronously loading the soft reference if needed */
+	TSubclassOf<UGameplayEffect> LoadGameplayEffectClass() const;
+
+	/** Returns the path of the effect class to grant, valid whether or not the soft reference is loaded */
+	FSoftObjectPath GetGameplayEffectClassPath() const;
+
 	// Gameplay effect to grant.
 	UPROPERTY(EditDefaultsOnly, Category=GameplayEffect)
 	TSubclassOf<UGameplayEffect> GameplayEffect = nullptr;
 
+	// Gameplay effect to grant, only loaded when the set is granted. Ignored when GameplayEffect is set.
+	UPROPERTY(EditDefaultsOnly, Category=GameplayEffect)
+	TSoftClassPtr<UGameplayEffect> SoftGameplayEffect;
+
 	// Level of gameplay effect to grant.
 	UPROPERTY(EditDefaultsOnly, Category=GameplayEffect)
 	float EffectLevel = 1.0f;
@@ -89,9 +115,27 @@ struct FKaosAbilitySet_AttributeSet
 	GENERATED_BODY()
 
 public:
+	/** Returns the attribute set class to grant, nullptr if it only has a soft reference that is not loaded yet */
+	TSubclassOf<UAttributeSet> GetAttributeSetClass() const;
+
+	/** Returns the attribute set class to grant, synchronously loading the soft reference if needed */
+	TSubclassOf<UAttributeSet> LoadAttributeSetClass() const;
+
+	/** Returns the path of the attribute set class to grant, valid whether or not the soft reference is loaded */
+	FSoftObjectPath GetAttributeSetClassPath() const;
+
 	// Attribute set to apply
 	UPROPERTY(EditDefaultsOnly, Category=AttributeSet)
 	TSubclassOf<UAttributeSet> AttributeSet = nullptr;
+
+	// Attribute set to apply, only loaded when the set is granted. Ignored when AttributeSet is set.
+	UPROPERTY(EditDefaultsOnly, Category=AttributeSet)
+	TSoftClassPtr<UAttributeSet> SoftAttributeSet;
+
+	// Remove the attribute set again when the ability set is removed. On a Kaos ASC the instance is pooled and reused, reset to class defaults, the next time it is granted.
+	// Only enable this if no other effects rely on the attributes of this set outliving the ability set.
+	UPROPERTY(EditDefaultsOnly, Category=AttributeSet)
+	bool bReleaseWithAbilitySet = false;
 };
 
 /**
@@ -111,12 +155,22 @@ struct FKaosAbilitySetHandle
 
 	void RemoveSet();
 
+	int32 GetHandleId() const { return HandleId; }
+
 private:
 	friend class UKaosGameplayAbilitySet;
 	friend class UKaosUtilitiesBlueprintLibrary;
+	friend class UKaosAbilitySystemComponent;
 
 	void AddAbilitySpecHandle(const FGameplayAbilitySpecHandle& Handle);
 	void AddGameplayEffectHandle(const FActiveGameplayEffectHandle& Handle);
+	void AddAttributeSet(UAttributeSet* Set);
+
+	/** Removes Set from InAbilitySystemComponent, returning it to the attribute set pool on Kaos ASCs */
+	static void ReleaseAttributeSet(UAbilitySystemComponent& InAbilitySystemComponent, UAttributeSet* Set);
+
+	/** Clears the granted abilities and removes the granted effects from AbilitySystemComponent, leaves the handle untouched. */
+	void RemoveGrantedItems(UAbilitySystemComponent& InAbilitySystemComponent) const;
 
 	// Handles to the granted abilities.
 	UPROPERTY()
@@ -125,6 +179,10 @@ private:
 	// Handles to the granted gameplay effects.
 	UPROPERTY()
 	TArray<FActiveGameplayEffectHandle> GameplayEffectHandles;
+
+	// Granted attribute sets that are released with this set.
+	UPROPERTY()
+	TArray<TWeakObjectPtr<UAttributeSet>> AttributeSets;
 	
 	int32 HandleId = 0;
 
@@ -134,6 +192,7 @@ private:
 	{
 		AbilitySpecHandles.Reset();
 		GameplayEffectHandles.Reset();
+		AttributeSets.Reset();
 		AbilitySystemComponent.Reset();
 		HandleId = 0;
 	}
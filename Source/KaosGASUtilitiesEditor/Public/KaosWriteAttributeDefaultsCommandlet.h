@@ -0,0 +1,43 @@
+﻿// Copyright (C) 2024, Daniel Moss
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "KaosWriteAttributeDefaultsCommandlet.generated.h"
+
+/**
+ * Compiles the global attribute defaults tables into the file at CookedAttributeDefaultsPath.
+ * Run it as a step before cooking (-run=KaosWriteAttributeDefaults) and stage the file with the build, i.e. through DirectoriesToAlwaysStageAsNonUFS.
+ * The file is stamped with the saved package hashes of the tables it was compiled from, cooked processes compare the stamp against their
+ * asset registry without loading the tables and parse them instead when it no longer matches. The cooked asset registry must keep package data.
+ */
+UCLASS()
+class UKaosWriteAttributeDefaultsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UKaosWriteAttributeDefaultsCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};